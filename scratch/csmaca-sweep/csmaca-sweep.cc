@@ -0,0 +1,308 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+// Runs the replications of a grid of scenarios in parallel and writes
+// the mean throughput of every grid point, with its confidence
+// interval over the replications, to one CSV file.
+//
+// The topology of a grid point is built once; every replication is a
+// forked copy of it which only reseeds its random streams, runs, and
+// reports its result through a pipe. At most "jobs" replications run
+// at the same time.
+//
+//   ./waf --run "csmaca-sweep --distance=10,47 --nodeAmount=2,5,10
+//                --replications=10 --output=sweep.csv"
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/csmaca-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaSweep");
+
+struct GridPoint
+{
+  double distance;
+  uint32_t nodeAmount;
+  uint32_t rate;
+};
+
+struct Job
+{
+  uint32_t point;
+  uint32_t replication;
+  int fd;
+};
+
+static std::vector<double>
+ParseList (std::string list)
+{
+  std::vector<double> values;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      values.push_back (std::atof (item.c_str ()));
+    }
+  return values;
+}
+
+static Ptr<CsmacaStatsController> g_controller;
+
+static void
+SinkRx (Ptr<const Packet> packet, const Address &from)
+{
+  g_controller->NotifyRx (packet->GetSize ());
+}
+
+/**
+ * Run one replication of the topology built by the parent, in a child
+ * process, and write "<mean> <half width> <warm-up>" to fd.
+ */
+static void
+RunReplication (int fd, uint32_t replication, const CsmacaHelper &csmaca, NetDeviceContainer devices,
+                const CsmacaTrafficHelper &traffic, ApplicationContainer generators,
+                Ptr<CsmacaTrafficSink> sink, double maxTime, double precision)
+{
+  // Streams take the run number when they are assigned, so assigning
+  // them again gives this replication its own random numbers
+  RngSeedManager::SetRun (replication + 1);
+  int64_t stream = csmaca.AssignStreams (devices, 0);
+  traffic.AssignStreams (generators, stream);
+
+  g_controller = CreateObject<CsmacaStatsController> ();
+  g_controller->SetAttribute ("MaxTime", TimeValue (Seconds (maxTime)));
+  g_controller->SetAttribute ("RelativePrecision", DoubleValue (precision));
+  g_controller->Start ();
+  sink->TraceConnectWithoutContext ("Rx", MakeCallback (&SinkRx));
+  Simulator::Run ();
+
+  char line[128];
+  int n = std::snprintf (line, sizeof (line), "%.17g %.17g %.17g\n", g_controller->GetMean (),
+                         g_controller->GetHalfWidth (), g_controller->GetWarmup ().GetSeconds ());
+  if (write (fd, line, n) != n)
+    {
+      _exit (1);
+    }
+  close (fd);
+  // Leave without destructors: the parent still owns the template
+  _exit (0);
+}
+
+/**
+ * Wait for a replication to end and collect its result.
+ */
+static void
+CollectOne (std::map<pid_t, Job> &running, std::vector<std::vector<double> > &results)
+{
+  int status;
+  pid_t pid = waitpid (-1, &status, 0);
+  if (pid < 0)
+    {
+      return;
+    }
+  std::map<pid_t, Job>::iterator i = running.find (pid);
+  if (i == running.end ())
+    {
+      return;
+    }
+  Job job = i->second;
+  running.erase (i);
+  std::string output;
+  char buffer[128];
+  ssize_t n;
+  while ((n = read (job.fd, buffer, sizeof (buffer))) > 0)
+    {
+      output.append (buffer, n);
+    }
+  close (job.fd);
+  std::istringstream iss (output);
+  double mean;
+  if (WIFEXITED (status) && WEXITSTATUS (status) == 0 && (iss >> mean))
+    {
+      results[job.point].push_back (mean);
+    }
+  else
+    {
+      std::cerr << "replication " << job.replication << " of point " << job.point << " failed" << std::endl;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string distances = "47";
+  std::string nodeAmounts = "2";
+  std::string rates = "114000000";
+  uint32_t replications = 10;
+  uint32_t jobs = 0;
+  uint32_t packetSize = 1500;
+  double interval = 0.0001;
+  double maxTime = 20;
+  double precision = 0.05;
+  double level = 0.95;
+  std::string output = "csmaca-sweep.csv";
+
+  CommandLine cmd;
+  cmd.AddValue ("distance", "Comma separated distances between nodes in meters", distances);
+  cmd.AddValue ("nodeAmount", "Comma separated numbers of nodes", nodeAmounts);
+  cmd.AddValue ("rate", "Comma separated transmission rates", rates);
+  cmd.AddValue ("replications", "Number of replications of every grid point", replications);
+  cmd.AddValue ("jobs", "Number of replications run at the same time, 0 for one per core", jobs);
+  cmd.AddValue ("packetSize", "Size of the frames in bytes", packetSize);
+  cmd.AddValue ("interval", "Mean time between frames of a sender in seconds", interval);
+  cmd.AddValue ("maxTime", "Longest measurement of a replication in seconds", maxTime);
+  cmd.AddValue ("precision", "Target relative half width within a replication", precision);
+  cmd.AddValue ("level", "Confidence level of the intervals over the replications", level);
+  cmd.AddValue ("output", "CSV file of the results", output);
+  cmd.Parse (argc, argv);
+
+  if (jobs == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      jobs = cores > 0 ? cores : 1;
+    }
+
+  std::vector<GridPoint> grid;
+  std::vector<double> distanceList = ParseList (distances);
+  std::vector<double> nodeAmountList = ParseList (nodeAmounts);
+  std::vector<double> rateList = ParseList (rates);
+  for (uint32_t d = 0; d < distanceList.size (); d++)
+    {
+      for (uint32_t n = 0; n < nodeAmountList.size (); n++)
+        {
+          for (uint32_t r = 0; r < rateList.size (); r++)
+            {
+              GridPoint point;
+              point.distance = distanceList[d];
+              point.nodeAmount = static_cast<uint32_t> (nodeAmountList[n]);
+              point.rate = static_cast<uint32_t> (rateList[r]);
+              grid.push_back (point);
+            }
+        }
+    }
+
+  std::map<pid_t, Job> running;
+  std::vector<std::vector<double> > results (grid.size ());
+  for (uint32_t p = 0; p < grid.size (); p++)
+    {
+      // Build the template of this grid point: every node but the first
+      // one sends to the first one
+      NodeContainer nodes;
+      nodes.Create (grid[p].nodeAmount);
+      MobilityHelper mobility;
+      mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                     "DeltaX", DoubleValue (grid[p].distance),
+                                     "GridWidth", UintegerValue (grid[p].nodeAmount));
+      mobility.Install (nodes);
+
+      CsmacaHelper csmaca;
+      csmaca.SetMac ("ns3::CsmacaMac", "Rate", UintegerValue (grid[p].rate));
+      NetDeviceContainer devices = csmaca.Install (nodes);
+
+      NodeContainer senders;
+      for (uint32_t i = 1; i < nodes.GetN (); i++)
+        {
+          senders.Add (nodes.Get (i));
+        }
+      CsmacaTrafficHelper traffic;
+      traffic.SetGeneratorAttribute ("Destination", Mac48AddressValue (Mac48Address::ConvertFrom (devices.Get (0)->GetAddress ())));
+      traffic.SetGeneratorAttribute ("PacketSize", UintegerValue (packetSize));
+      traffic.SetGeneratorAttribute ("ArrivalProcess", StringValue ("Poisson"));
+      traffic.SetGeneratorAttribute ("Interval", TimeValue (Seconds (interval)));
+      ApplicationContainer generators = traffic.InstallGenerator (senders);
+      ApplicationContainer sinks = traffic.InstallSink (NodeContainer (nodes.Get (0)));
+      Ptr<CsmacaTrafficSink> sink = DynamicCast<CsmacaTrafficSink> (sinks.Get (0));
+
+      for (uint32_t r = 0; r < replications; r++)
+        {
+          while (running.size () >= jobs)
+            {
+              CollectOne (running, results);
+            }
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("cannot create a pipe");
+            }
+          std::cout.flush ();
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("cannot fork");
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              RunReplication (fds[1], r, csmaca, devices, traffic, generators, sink, maxTime, precision);
+            }
+          close (fds[1]);
+          Job job;
+          job.point = p;
+          job.replication = r;
+          job.fd = fds[0];
+          running[pid] = job;
+        }
+      Simulator::Destroy ();
+    }
+  while (!running.empty ())
+    {
+      CollectOne (running, results);
+    }
+
+  std::ofstream file (output.c_str ());
+  file << "distance,nodeAmount,rate,replications,mean,halfWidth" << std::endl;
+  for (uint32_t p = 0; p < grid.size (); p++)
+    {
+      uint32_t n = results[p].size ();
+      double sum = 0;
+      double sumSquares = 0;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          sum += results[p][i];
+          sumSquares += results[p][i] * results[p][i];
+        }
+      double mean = n > 0 ? sum / n : 0;
+      double halfWidth = 0;
+      if (n > 1)
+        {
+          double variance = std::max (0.0, (sumSquares - sum * sum / n) / (n - 1));
+          halfWidth = CsmacaStatsController::GetStudentQuantile (level, n - 1) * std::sqrt (variance / n);
+        }
+      file << grid[p].distance << "," << grid[p].nodeAmount << "," << grid[p].rate << ","
+           << n << "," << mean << "," << halfWidth << std::endl;
+    }
+  return 0;
+}
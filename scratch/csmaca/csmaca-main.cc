@@ -30,18 +30,12 @@
 
 #include "csmaca-apps.h"
 
-#define STARTAN 1
-#define ENDAN   20
-
 using namespace ns3;
 using namespace std;
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaSimulator");
 
-Time endTime = Seconds (0);
-Time startAnalysisTime = Seconds (0);
-bool isAnalysisTime = false;
-uint32_t totalPacketSize = 0;
+Ptr<CsmacaStatsController> statsController;
 
 /**********************************************************
                    Trace data
@@ -52,28 +46,8 @@ AppSenderRx (std::string path,
 	     uint32_t numPkts,
              Ptr<Packet> packet)
 {
-  if (isAnalysisTime){
-    totalPacketSize += packet->GetSize ();
-  }
-  NS_LOG_INFO (path << "[numPkts]=" << numPkts << " [total]=" << totalPacketSize);
-}
-
-void
-AppSenderTx (std::string path,
-             Ptr<const Packet> packet)
-{
-
-
-  if (Simulator::Now() >= Seconds (STARTAN) && !isAnalysisTime) {
-    isAnalysisTime = true;
-    startAnalysisTime = Simulator::Now();
-  }
-
-  if(Simulator::Now() >= Seconds (STARTAN) + Seconds (ENDAN)) {
-    Time time = Simulator::Now() - startAnalysisTime;
-    std::cout << (totalPacketSize * 8 / time.GetSeconds ()) / 1000000 << std::endl;
-    Simulator::Stop();
-  }
+  statsController->NotifyRx (packet->GetSize ());
+  NS_LOG_INFO (path << "[numPkts]=" << numPkts);
 }
 
 void
@@ -91,6 +65,9 @@ int main (int argc, char *argv[]) {
   int distance = 47;
   int rate = 114000000;
   uint64_t stream = 0;
+  double window = 0;
+  double maxTime = 20;
+  double precision = 0.05;
 
   // Set up command line parameters used to control the experiment.
   CommandLine cmd;
@@ -98,6 +75,9 @@ int main (int argc, char *argv[]) {
   cmd.AddValue ("nodeAmount", "Number of nodes", nodeAmount);
   cmd.AddValue ("rate", "transmission rate", rate);
   cmd.AddValue ("stream", "random stream", stream);
+  cmd.AddValue ("window", "measurement window after the warm-up in seconds, 0 to stop on precision", window);
+  cmd.AddValue ("maxTime", "longest measurement in seconds", maxTime);
+  cmd.AddValue ("precision", "target relative half width of the 95% confidence interval", precision);
   cmd.Parse (argc, argv);
 
   //------------------------------------------------------------
@@ -112,39 +92,10 @@ int main (int argc, char *argv[]) {
   //------------------------------------------------------------
   //-- Create Net device
   //--------------------------------------------
-  Config::SetDefault ("ns3::CsmacaMac::Rate", UintegerValue(rate));
-
-  NS_LOG_INFO ("Create traffic source & sink.");
-  Ptr<CsmacaNetDevice> netDevices[nodeAmount];
-  NetDeviceContainer netDeviceContainer;
-  for(int i = 0; i < nodeAmount; i++)
-    {
-      Ptr<Node> node = NodeList::GetNode (i);
-      netDevices [i] = CreateObject<CsmacaNetDevice>();
-      netDeviceContainer.Add(netDevices [i]);
-      node->AddDevice (netDevices [i]);
-    }
-  int64_t currentStream = stream;
-  for (int i = 0; i < nodeAmount; i++)
-    {
-      Ptr<Node>            node     = NodeList::GetNode (i);
-      Ptr<CsmacaNetDevice> device   = netDevices [i];
-      Ptr<CsmacaPhy>       phy      = device->GetPhy ();
-      phy->SetMobility (node);
-      phy->SetDevice (device);
-      netDevices [i]->SetAddress (Mac48Address::Allocate ());
-      currentStream += netDevices [i]->GetMac ()->AssignStreams (currentStream);
-      currentStream += netDevices [i]->GetMac ()->GetPhy ()->AssignStreams (currentStream);
-    }
-  for (int i = 0; i < nodeAmount; i++)
-    {
-      Ptr<CsmacaChannel> channel= netDevices [i]->GetMac ()->GetPhy ()->GetChannel ();
-      for (int j = 0; j < nodeAmount; j++)
-        {
-          Ptr<CsmacaPhy> phy = netDevices [j]->GetMac ()->GetPhy ();
-          channel->Add (phy);
-        }
-    }
+  CsmacaHelper csmaca;
+  csmaca.SetMac ("ns3::CsmacaMac", "Rate", UintegerValue (rate));
+  NetDeviceContainer netDeviceContainer = csmaca.Install (nodes);
+  csmaca.AssignStreams (netDeviceContainer, stream);
   Ipv4AddressHelper ipAddrs;
   ipAddrs.SetBase ("192.168.0.0", "255.255.255.0");
   ipAddrs.Assign (netDeviceContainer);
@@ -187,13 +138,26 @@ int main (int argc, char *argv[]) {
   Config::Set (Receiver1 + "NumPackets" , UintegerValue (10000));
   
   Config::Connect ("/NodeList/*/ApplicationList/*/$CsmacaReceiver/Rx", MakeCallback (&AppSenderRx));
-  Config::Connect ("/NodeList/*/ApplicationList/*/$CsmacaSender/Tx", MakeCallback (&AppSenderTx));
   Config::Connect ("/$ns3::CsmacaPhy/StartTx", MakeCallback (&StartTxCallback));
   //------------------------------------------------------------
   //-- Run the simulation
   //--------------------------------------------
+  statsController = CreateObject<CsmacaStatsController> ();
+  statsController->SetAttribute ("Window", TimeValue (Seconds (window)));
+  statsController->SetAttribute ("MaxTime", TimeValue (Seconds (maxTime)));
+  statsController->SetAttribute ("RelativePrecision", DoubleValue (precision));
+  statsController->Start ();
+
   NS_LOG_INFO ("Run Simulation.");
   Simulator::Run ();
+  std::cout << statsController->GetMean () / 1000000 << std::endl;
+  NS_LOG_INFO ("warm-up=" << statsController->GetWarmup ()
+               << " halfWidth=" << statsController->GetHalfWidth () / 1000000);
+  if (CsmacaCounters::IsEnabled ())
+    {
+      CsmacaCounters::Print (std::cout);
+    }
+  statsController = 0;
   Simulator::Destroy ();
   
   // end main
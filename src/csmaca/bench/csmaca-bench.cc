@@ -0,0 +1,325 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+// Microbenchmarks of the hot paths of the csmaca module. Every
+// benchmark runs at several sizes and is repeated with twice as many
+// iterations until it lasts at least minTime; one CSV line per run
+// reports the time and the number of heap allocations per operation.
+//
+//   ./waf --run "csmaca-bench --minTime=0.5 --output=bench.csv"
+//
+// The size is the number of concurrent signals for the interference
+// helper, the number of attached PHYs for the channel, the queue depth
+// for the MAC queue and the payload size in bytes for the headers.
+
+#include <sys/time.h>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/csmaca-module.h"
+
+using namespace ns3;
+
+static uint64_t g_allocations = 0;
+
+// Dynamic exception specifications are an error from C++17 on
+#if __cplusplus >= 201103L
+#define CSMACA_BENCH_THROW_BAD_ALLOC
+#define CSMACA_BENCH_NOTHROW noexcept
+#else
+#define CSMACA_BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define CSMACA_BENCH_NOTHROW throw ()
+#endif
+
+void *
+operator new (std::size_t size) CSMACA_BENCH_THROW_BAD_ALLOC
+{
+  g_allocations++;
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) CSMACA_BENCH_NOTHROW
+{
+  std::free (p);
+}
+
+/**
+ * Accumulates the wall clock time and the allocations of the timed
+ * parts of a benchmark, which may be interrupted to clean up.
+ */
+class Measurement
+{
+public:
+  Measurement ()
+    : m_ns (0),
+      m_allocations (0),
+      m_ops (0)
+  {
+  }
+  void Start (void)
+  {
+    m_startAllocations = g_allocations;
+    gettimeofday (&m_start, 0);
+  }
+  void Stop (uint64_t ops)
+  {
+    struct timeval end;
+    gettimeofday (&end, 0);
+    m_allocations += g_allocations - m_startAllocations;
+    m_ns += (end.tv_sec - m_start.tv_sec) * 1000000000.0 + (end.tv_usec - m_start.tv_usec) * 1000.0;
+    m_ops += ops;
+  }
+  double GetNs (void) const
+  {
+    return m_ns;
+  }
+  double GetNsPerOp (void) const
+  {
+    return m_ops == 0 ? 0 : m_ns / m_ops;
+  }
+  double GetAllocationsPerOp (void) const
+  {
+    return m_ops == 0 ? 0 : double (m_allocations) / m_ops;
+  }
+
+private:
+  struct timeval m_start;
+  uint64_t m_startAllocations;
+  double m_ns;
+  uint64_t m_allocations;
+  uint64_t m_ops;
+};
+
+typedef void (*Benchmark) (uint32_t size, uint64_t iterations, Measurement &measurement);
+
+// Add size overlapping signals, then forget them
+static void
+BenchInterferenceAdd (uint32_t size, uint64_t iterations, Measurement &measurement)
+{
+  CsmacaInterferenceHelper interference;
+  CsmacaPreamble preamble;
+  measurement.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    {
+      for (uint32_t j = 0; j < size; j++)
+        {
+          interference.Add (1000, MicroSeconds (100 + j), 1e-9, preamble);
+        }
+      interference.EraseEvents ();
+    }
+  measurement.Stop (iterations * size);
+}
+
+// Decide the reception of one signal among size overlapping ones
+static void
+BenchInterferenceSnrPer (uint32_t size, uint64_t iterations, Measurement &measurement)
+{
+  CsmacaInterferenceHelper interference;
+  CsmacaPreamble preamble;
+  Ptr<CsmacaInterferenceHelper::Event> event = interference.Add (1000, MicroSeconds (1000), 1e-6, preamble);
+  interference.NotifyRxStart ();
+  for (uint32_t j = 1; j < size; j++)
+    {
+      interference.Add (1000, MicroSeconds (10 * j), 1e-12, preamble);
+    }
+  measurement.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    {
+      interference.CalculateSnrPer (event);
+    }
+  measurement.Stop (iterations);
+  interference.NotifyRxEnd ();
+}
+
+// Send one frame to size - 1 receivers; the scheduled receptions are
+// dropped between batches, out of the measurement
+static void
+BenchChannelSend (uint32_t size, uint64_t iterations, Measurement &measurement)
+{
+  Ptr<CsmacaChannel> channel = CreateObject<CsmacaChannel> ();
+  std::vector<Ptr<CsmacaPhy> > phys;
+  for (uint32_t j = 0; j < size; j++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (j, 0, 0));
+      Ptr<CsmacaPhy> phy = CreateObject<CsmacaPhy> ();
+      phy->SetMobility (mobility);
+      phy->SetChannel (channel);
+      phys.push_back (phy);
+    }
+  Ptr<Packet> packet = Create<Packet> (1000);
+  CsmacaPreamble preamble;
+  const uint64_t batch = 1024;
+  for (uint64_t done = 0; done < iterations; done += batch)
+    {
+      uint64_t n = std::min (batch, iterations - done);
+      measurement.Start ();
+      for (uint64_t i = 0; i < n; i++)
+        {
+          channel->Send (packet, preamble, 16.0206, phys[0]);
+        }
+      measurement.Stop (n);
+      Simulator::Destroy ();
+    }
+}
+
+// Fill the queue up to size frames, then drain it
+static void
+BenchQueue (uint32_t size, uint64_t iterations, Measurement &measurement)
+{
+  Ptr<CsmacaMacQueue> queue = CreateObject<CsmacaMacQueue> ();
+  queue->SetAttribute ("MaxPacketNumber", UintegerValue (size));
+  Ptr<const Packet> packet = Create<Packet> (1000);
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_DATA);
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  CsmacaMacHeader out;
+  measurement.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    {
+      for (uint32_t j = 0; j < size; j++)
+        {
+          queue->Enqueue (packet, hdr);
+        }
+      for (uint32_t j = 0; j < size; j++)
+        {
+          queue->Dequeue (&out);
+        }
+    }
+  measurement.Stop (iterations * size);
+}
+
+// Build a data frame of size payload bytes, serialize it to bytes as
+// the channel would carry it, and parse its header back
+static void
+BenchHeader (uint32_t size, uint64_t iterations, Measurement &measurement)
+{
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_DATA);
+  hdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  hdr.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  hdr.SetSequenceNumber (1);
+  std::vector<uint8_t> buffer (hdr.GetSerializedSize () + size);
+  measurement.Start ();
+  for (uint64_t i = 0; i < iterations; i++)
+    {
+      Ptr<Packet> packet = Create<Packet> (size);
+      packet->AddHeader (hdr);
+      packet->CopyData (&buffer[0], buffer.size ());
+      Ptr<Packet> received = Create<Packet> (&buffer[0], buffer.size ());
+      CsmacaMacHeader parsed;
+      received->RemoveHeader (parsed);
+    }
+  measurement.Stop (iterations);
+}
+
+static void
+Run (std::ostream &os, std::string name, Benchmark benchmark,
+     const std::vector<uint32_t> &sizes, double minTime)
+{
+  for (std::vector<uint32_t>::const_iterator i = sizes.begin (); i != sizes.end (); i++)
+    {
+      uint64_t iterations = 1;
+      Measurement measurement;
+      while (true)
+        {
+          measurement = Measurement ();
+          benchmark (*i, iterations, measurement);
+          if (measurement.GetNs () >= minTime * 1e9)
+            {
+              break;
+            }
+          iterations *= 2;
+        }
+      os << name << "," << *i << "," << iterations << ","
+         << measurement.GetNsPerOp () << "," << measurement.GetAllocationsPerOp () << std::endl;
+    }
+}
+
+static std::vector<uint32_t>
+Sizes (uint32_t a, uint32_t b, uint32_t c)
+{
+  std::vector<uint32_t> sizes;
+  sizes.push_back (a);
+  sizes.push_back (b);
+  sizes.push_back (c);
+  return sizes;
+}
+
+int
+main (int argc, char *argv[])
+{
+  double minTime = 0.2;
+  std::string filter;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("minTime", "shortest measurement of a benchmark at one size in seconds", minTime);
+  cmd.AddValue ("filter", "run only the benchmarks whose name contains this string", filter);
+  cmd.AddValue ("output", "CSV file to write, standard output if empty", output);
+  cmd.Parse (argc, argv);
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+    }
+  std::ostream &os = output.empty () ? std::cout : file;
+  os << "benchmark,size,iterations,nsPerOp,allocationsPerOp" << std::endl;
+
+  struct
+  {
+    const char *name;
+    Benchmark benchmark;
+    std::vector<uint32_t> sizes;
+  } benchmarks[] = {
+    { "interference-add", &BenchInterferenceAdd, Sizes (1, 8, 64) },
+    { "interference-snr-per", &BenchInterferenceSnrPer, Sizes (1, 8, 64) },
+    { "channel-send", &BenchChannelSend, Sizes (2, 32, 1024) },
+    { "queue-enqueue-dequeue", &BenchQueue, Sizes (1, 64, 1024) },
+    { "header-roundtrip", &BenchHeader, Sizes (64, 512, 1500) },
+  };
+  for (uint32_t i = 0; i < sizeof (benchmarks) / sizeof (benchmarks[0]); i++)
+    {
+      if (std::string (benchmarks[i].name).find (filter) == std::string::npos)
+        {
+          continue;
+        }
+      Run (os, benchmarks[i].name, benchmarks[i].benchmark, benchmarks[i].sizes, minTime);
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
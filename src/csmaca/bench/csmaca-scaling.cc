@@ -0,0 +1,276 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+// Measures how the cost of a simulation grows with the number of
+// nodes. Every node of a cell (all nodes in range of each other) or of
+// a grid sends saturated traffic to a neighbour for simTime; one CSV
+// line per configuration reports the wall time of the setup and of the
+// run, the number of scheduler events run (cancelled ones excluded),
+// the peak resident set size and the simulated throughput.
+//
+// Every configuration runs in its own process, one after the other, so
+// that the peak memory is its own and the runs do not compete for the
+// cores.
+//
+//   ./waf --run "csmaca-scaling --nodeAmount=2,100,10000 --topology=cell,grid
+//                --output=scaling.csv"
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/csmaca-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaScaling");
+
+static uint64_t g_events = 0;
+
+/**
+ * The default scheduler, counting the events it hands to the simulator
+ * which have not been cancelled.
+ */
+class CsmacaCountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+  virtual Scheduler::Event RemoveNext (void);
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaCountingScheduler);
+
+TypeId
+CsmacaCountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaCountingScheduler")
+    .SetParent<MapScheduler> ()
+    .AddConstructor<CsmacaCountingScheduler> ()
+  ;
+  return tid;
+}
+
+Scheduler::Event
+CsmacaCountingScheduler::RemoveNext (void)
+{
+  Scheduler::Event ev = MapScheduler::RemoveNext ();
+  // Cancelled events stay in the scheduler and are skipped by the
+  // simulator once removed; only the events which run are counted
+  if (!ev.impl->IsCancelled ())
+    {
+      g_events++;
+    }
+  return ev;
+}
+
+static std::vector<std::string>
+ParseList (std::string list)
+{
+  std::vector<std::string> values;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      values.push_back (item);
+    }
+  return values;
+}
+
+static double
+GetWallSeconds (void)
+{
+  struct timeval now;
+  gettimeofday (&now, 0);
+  return now.tv_sec + now.tv_usec / 1e6;
+}
+
+/**
+ * Build and run one configuration in a child process, and write
+ * "<setup time> <run time> <events> <peak rss> <throughput>" to fd.
+ */
+static void
+RunConfiguration (int fd, uint32_t nodeAmount, double spacing,
+                  uint32_t packetSize, double simTime)
+{
+  double start = GetWallSeconds ();
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CsmacaCountingScheduler");
+  Simulator::SetScheduler (scheduler);
+
+  NodeContainer nodes;
+  nodes.Create (nodeAmount);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (spacing),
+                                 "DeltaY", DoubleValue (spacing),
+                                 "GridWidth", UintegerValue (std::ceil (std::sqrt (double (nodeAmount)))));
+  mobility.Install (nodes);
+
+  CsmacaHelper csmaca;
+  NetDeviceContainer devices = csmaca.Install (nodes);
+  csmaca.AssignStreams (devices, 0);
+  // Nodes send to each other in pairs, the last one of an odd number
+  // of nodes to the one before it
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      uint32_t peer = (i ^ 1) < devices.GetN () ? (i ^ 1) : i - 1;
+      Ptr<CsmacaMac> mac = DynamicCast<CsmacaNetDevice> (devices.Get (i))->GetMac ();
+      mac->SetAttribute ("SaturationPacketSize", UintegerValue (packetSize));
+      mac->SetAttribute ("SaturationDestination",
+                         Mac48AddressValue (Mac48Address::ConvertFrom (devices.Get (peer)->GetAddress ())));
+      mac->SetAttribute ("SaturationSource", BooleanValue (true));
+    }
+  CsmacaTrafficHelper traffic;
+  ApplicationContainer sinks = traffic.InstallSink (nodes);
+
+  double setup = GetWallSeconds ();
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  double end = GetWallSeconds ();
+
+  uint64_t rx = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      rx += DynamicCast<CsmacaTrafficSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  char line[256];
+  int n = std::snprintf (line, sizeof (line), "%.6f %.6f %llu %ld %.17g\n", setup - start, end - setup,
+                         (unsigned long long) g_events, usage.ru_maxrss, rx * 8 / simTime);
+  if (write (fd, line, n) != n)
+    {
+      _exit (1);
+    }
+  close (fd);
+  // Leave without tearing down thousands of nodes
+  _exit (0);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string nodeAmounts = "2,10,100,1000,10000";
+  std::string topologies = "cell,grid";
+  double cellSpacing = 1;
+  double gridSpacing = 50;
+  uint32_t packetSize = 1000;
+  double simTime = 1;
+  std::string output = "csmaca-scaling.csv";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodeAmount", "Comma separated numbers of nodes", nodeAmounts);
+  cmd.AddValue ("topology", "Comma separated topologies, cell or grid", topologies);
+  cmd.AddValue ("cellSpacing", "Distance between neighbours in a cell in meters", cellSpacing);
+  cmd.AddValue ("gridSpacing", "Distance between neighbours in a grid in meters", gridSpacing);
+  cmd.AddValue ("packetSize", "Size of the saturated frames in bytes", packetSize);
+  cmd.AddValue ("simTime", "Simulated time of every configuration in seconds", simTime);
+  cmd.AddValue ("output", "CSV file of the results", output);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> topologyList = ParseList (topologies);
+  std::vector<std::string> nodeAmountList = ParseList (nodeAmounts);
+
+  std::ofstream file (output.c_str ());
+  file << "topology,nodeAmount,simTime,setupTime,runTime,events,eventsPerSecond,peakRssKb,throughput" << std::endl;
+  for (uint32_t t = 0; t < topologyList.size (); t++)
+    {
+      double spacing = cellSpacing;
+      if (topologyList[t] == "cell")
+        {
+          spacing = cellSpacing;
+        }
+      else if (topologyList[t] == "grid")
+        {
+          spacing = gridSpacing;
+        }
+      else
+        {
+          NS_FATAL_ERROR ("unknown topology " << topologyList[t]);
+        }
+      for (uint32_t n = 0; n < nodeAmountList.size (); n++)
+        {
+          uint32_t nodeAmount = std::atoi (nodeAmountList[n].c_str ());
+          if (nodeAmount < 2)
+            {
+              NS_FATAL_ERROR ("a configuration needs at least two nodes");
+            }
+          int fds[2];
+          if (pipe (fds) != 0)
+            {
+              NS_FATAL_ERROR ("cannot create a pipe");
+            }
+          std::cout.flush ();
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("cannot fork");
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              RunConfiguration (fds[1], nodeAmount, spacing, packetSize, simTime);
+            }
+          close (fds[1]);
+          std::string result;
+          char buffer[256];
+          ssize_t size;
+          while ((size = read (fds[0], buffer, sizeof (buffer))) > 0)
+            {
+              result.append (buffer, size);
+            }
+          close (fds[0]);
+          int status;
+          waitpid (pid, &status, 0);
+
+          std::istringstream iss (result);
+          double setupTime;
+          double runTime;
+          uint64_t events;
+          long peakRss;
+          double throughput;
+          if (!WIFEXITED (status) || WEXITSTATUS (status) != 0
+              || !(iss >> setupTime >> runTime >> events >> peakRss >> throughput))
+            {
+              std::cerr << topologyList[t] << " of " << nodeAmount << " nodes failed" << std::endl;
+              continue;
+            }
+          file << topologyList[t] << "," << nodeAmount << "," << simTime << ","
+               << setupTime << "," << runTime << "," << events << ","
+               << (runTime > 0 ? events / runTime : 0) << "," << peakRss << "," << throughput << std::endl;
+          NS_LOG_INFO (topologyList[t] << " " << nodeAmount << " nodes: " << runTime << " s");
+        }
+    }
+  return 0;
+}
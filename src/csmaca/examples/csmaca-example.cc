@@ -1,26 +1,104 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
 
+// Stations sending to the first one straight through their devices,
+// without the Internet stack. Prints the throughput at the receiver and
+// the one-way delay of every flow.
+
+#include <iostream>
+#include <vector>
 #include "ns3/core-module.h"
-#include "ns3/csmaca-helper.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/csmaca-module.h"
 
 using namespace ns3;
 
-
 int 
 main (int argc, char *argv[])
 {
-  bool verbose = true;
+  uint32_t nodeAmount = 5;
+  uint32_t packetSize = 1000;
+  std::string process = "Poisson";
+  double interval = 0.001;
+  double simulationTime = 10;
 
   CommandLine cmd;
-  cmd.AddValue ("verbose", "Tell application to log if true", verbose);
-
+  cmd.AddValue ("nodeAmount", "Number of stations", nodeAmount);
+  cmd.AddValue ("packetSize", "Size of the frames in bytes", packetSize);
+  cmd.AddValue ("process", "Arrival process: Constant, Poisson, OnOff or Trace", process);
+  cmd.AddValue ("interval", "Mean time between frames of a sender in seconds", interval);
+  cmd.AddValue ("simulationTime", "Simulated time in seconds", simulationTime);
   cmd.Parse (argc,argv);
 
-  /* ... */
+  NodeContainer nodes;
+  nodes.Create (nodeAmount);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (5.0),
+                                 "DeltaY", DoubleValue (5.0),
+                                 "GridWidth", UintegerValue (10));
+  mobility.Install (nodes);
+
+  CsmacaHelper csmaca;
+  NetDeviceContainer devices = csmaca.Install (nodes);
+  int64_t stream = csmaca.AssignStreams (devices, 0);
 
+  NodeContainer senders;
+  for (uint32_t i = 1; i < nodeAmount; i++)
+    {
+      senders.Add (nodes.Get (i));
+    }
+  CsmacaTrafficHelper traffic;
+  traffic.SetGeneratorAttribute ("Destination", Mac48AddressValue (Mac48Address::ConvertFrom (devices.Get (0)->GetAddress ())));
+  traffic.SetGeneratorAttribute ("PacketSize", UintegerValue (packetSize));
+  traffic.SetGeneratorAttribute ("ArrivalProcess", StringValue (process));
+  traffic.SetGeneratorAttribute ("Interval", TimeValue (Seconds (interval)));
+  ApplicationContainer generators = traffic.InstallGenerator (senders);
+  traffic.AssignStreams (generators, stream);
+  generators.Start (Seconds (0.0));
+  generators.Stop (Seconds (simulationTime));
+  ApplicationContainer sinks = traffic.InstallSink (NodeContainer (nodes.Get (0)));
+
+  Simulator::Stop (Seconds (simulationTime));
   Simulator::Run ();
+
+  Ptr<CsmacaTrafficSink> sink = DynamicCast<CsmacaTrafficSink> (sinks.Get (0));
+  std::cout << sink->GetTotalRx () * 8 / simulationTime / 1000000 << " Mbit/s" << std::endl;
+  std::vector<Mac48Address> flows = sink->GetFlows ();
+  for (std::vector<Mac48Address>::const_iterator i = flows.begin (); i != flows.end (); i++)
+    {
+      CsmacaLatencyHistogram delay = sink->GetDelayHistogram (*i);
+      CsmacaLatencyHistogram jitter = sink->GetJitterHistogram (*i);
+      std::cout << *i << " delay mean=" << delay.GetMean ().GetMicroSeconds ()
+                << "us p50=" << delay.GetPercentile (50).GetMicroSeconds ()
+                << "us p99=" << delay.GetPercentile (99).GetMicroSeconds ()
+                << "us jitter p99=" << jitter.GetPercentile (99).GetMicroSeconds ()
+                << "us" << std::endl;
+    }
+
+  if (CsmacaCounters::IsEnabled ())
+    {
+      CsmacaCounters::Print (std::cout);
+    }
   Simulator::Destroy ();
   return 0;
 }
-
-
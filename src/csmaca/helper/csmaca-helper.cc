@@ -1,11 +1,190 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
 
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/mac48-address.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/csmaca-net-device.h"
+#include "ns3/csmaca-mac.h"
+#include "ns3/csmaca-phy.h"
+#include "ns3/csmaca-mac-queue.h"
+#include "ns3/csmaca-qos-utils.h"
 #include "csmaca-helper.h"
+#include "ns3/csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaHelper");
 
 namespace ns3 {
 
-/* ... */
+CsmacaHelper::CsmacaHelper ()
+  : m_setQueue (false)
+{
+  m_deviceFactory.SetTypeId ("ns3::CsmacaNetDevice");
+  m_macFactory.SetTypeId ("ns3::CsmacaMac");
+  m_phyFactory.SetTypeId ("ns3::CsmacaPhy");
+  m_queueFactory.SetTypeId ("ns3::CsmacaMacQueue");
+  m_lossFactory.SetTypeId ("ns3::LogDistancePropagationLossModel");
+  m_delayFactory.SetTypeId ("ns3::ConstantSpeedPropagationDelayModel");
+}
+
+void
+CsmacaHelper::SetPhy (std::string type,
+                      std::string n0, const AttributeValue &v0,
+                      std::string n1, const AttributeValue &v1,
+                      std::string n2, const AttributeValue &v2,
+                      std::string n3, const AttributeValue &v3)
+{
+  m_phyFactory.SetTypeId (type);
+  m_phyFactory.Set (n0, v0);
+  m_phyFactory.Set (n1, v1);
+  m_phyFactory.Set (n2, v2);
+  m_phyFactory.Set (n3, v3);
+}
+
+void
+CsmacaHelper::SetMac (std::string type,
+                      std::string n0, const AttributeValue &v0,
+                      std::string n1, const AttributeValue &v1,
+                      std::string n2, const AttributeValue &v2,
+                      std::string n3, const AttributeValue &v3)
+{
+  m_macFactory.SetTypeId (type);
+  m_macFactory.Set (n0, v0);
+  m_macFactory.Set (n1, v1);
+  m_macFactory.Set (n2, v2);
+  m_macFactory.Set (n3, v3);
+}
+
+void
+CsmacaHelper::SetQueue (std::string type,
+                        std::string n0, const AttributeValue &v0,
+                        std::string n1, const AttributeValue &v1,
+                        std::string n2, const AttributeValue &v2,
+                        std::string n3, const AttributeValue &v3)
+{
+  m_queueFactory.SetTypeId (type);
+  m_queueFactory.Set (n0, v0);
+  m_queueFactory.Set (n1, v1);
+  m_queueFactory.Set (n2, v2);
+  m_queueFactory.Set (n3, v3);
+  m_setQueue = true;
+}
+
+void
+CsmacaHelper::SetDeviceAttribute (std::string n, const AttributeValue &v)
+{
+  m_deviceFactory.Set (n, v);
+}
 
+void
+CsmacaHelper::SetPropagationLoss (std::string type,
+                                  std::string n0, const AttributeValue &v0,
+                                  std::string n1, const AttributeValue &v1)
+{
+  m_lossFactory.SetTypeId (type);
+  m_lossFactory.Set (n0, v0);
+  m_lossFactory.Set (n1, v1);
+}
+
+void
+CsmacaHelper::SetPropagationDelay (std::string type,
+                                   std::string n0, const AttributeValue &v0,
+                                   std::string n1, const AttributeValue &v1)
+{
+  m_delayFactory.SetTypeId (type);
+  m_delayFactory.Set (n0, v0);
+  m_delayFactory.Set (n1, v1);
+}
+
+Ptr<CsmacaChannel>
+CsmacaHelper::CreateChannel (void) const
+{
+  Ptr<CsmacaChannel> channel = CreateObject<CsmacaChannel> ();
+  channel->SetPropagationLossModel (m_lossFactory.Create<PropagationLossModel> ());
+  channel->SetPropagationDelayModel (m_delayFactory.Create<PropagationDelayModel> ());
+  return channel;
+}
+
+NetDeviceContainer
+CsmacaHelper::Install (NodeContainer c) const
+{
+  return Install (c, CreateChannel ());
+}
+
+NetDeviceContainer
+CsmacaHelper::Install (NodeContainer c, Ptr<CsmacaChannel> channel) const
+{
+  CSMACA_LOG_FUNCTION (this << channel);
+  NetDeviceContainer devices;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      Ptr<CsmacaNetDevice> device = m_deviceFactory.Create<CsmacaNetDevice> ();
+      Ptr<CsmacaMac> mac = m_macFactory.Create<CsmacaMac> ();
+      Ptr<CsmacaPhy> phy = m_phyFactory.Create<CsmacaPhy> ();
+      mac->SetPhy (phy);
+      mac->SetNetDevice (device);
+      if (m_setQueue)
+        {
+          for (uint32_t ac = 0; ac < CSMACA_AC_N; ac++)
+            {
+              Ptr<CsmacaMacQueue> queue = m_queueFactory.Create<CsmacaMacQueue> ();
+              if (ac == CSMACA_AC_BE)
+                {
+                  mac->SetQueue (queue);
+                }
+              else
+                {
+                  mac->GetAccessCategory (static_cast<enum CsmacaAcIndex> (ac))->SetQueue (queue);
+                }
+            }
+        }
+      device->SetMac (mac);
+      device->SetPhy (phy);
+      phy->SetDevice (device);
+      phy->SetMobility (node);
+      phy->SetChannel (channel);
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      devices.Add (device);
+    }
+  return devices;
+}
 
+int64_t
+CsmacaHelper::AssignStreams (NetDeviceContainer c, int64_t stream) const
+{
+  int64_t currentStream = stream;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<CsmacaNetDevice> device = DynamicCast<CsmacaNetDevice> (*i);
+      if (device == 0)
+        {
+          continue;
+        }
+      currentStream += device->GetMac ()->AssignStreams (currentStream);
+      currentStream += device->GetPhy ()->AssignStreams (currentStream);
+    }
+  return currentStream - stream;
 }
 
+} // namespace ns3
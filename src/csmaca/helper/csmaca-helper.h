@@ -1,14 +1,113 @@
-/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
 #ifndef CSMACA_HELPER_H
 #define CSMACA_HELPER_H
 
-#include "ns3/csmaca.h"
+#include <stdint.h>
+#include <string>
+#include "ns3/attribute.h"
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/csmaca-channel.h"
 
 namespace ns3 {
 
-/* ... */
+/**
+ * Builds csmaca devices on a set of nodes.
+ *
+ * All the devices of one Install call share a single channel, so
+ * setting up n nodes takes O(n) time and memory. Each part of the
+ * device is built by its own object factory, whose type and attributes
+ * are set through the Set* methods before calling Install.
+ */
+class CsmacaHelper
+{
+public:
+  CsmacaHelper ();
 
-}
+  /**
+   * \param type the type of the PHY, ns3::CsmacaPhy by default
+   */
+  void SetPhy (std::string type,
+               std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+               std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+               std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+               std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+  /**
+   * \param type the type of the MAC, ns3::CsmacaMac by default
+   */
+  void SetMac (std::string type,
+               std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+               std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+               std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+               std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+  /**
+   * Give every access category a queue of the given type. Unless this
+   * is called, the access categories keep the queue of their QueueType.
+   */
+  void SetQueue (std::string type,
+                 std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                 std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                 std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                 std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+  void SetDeviceAttribute (std::string n, const AttributeValue &v);
+  void SetPropagationLoss (std::string type,
+                           std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                           std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue ());
+  void SetPropagationDelay (std::string type,
+                            std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                            std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue ());
 
-#endif /* CSMACA_HELPER_H */
+  /**
+   * \return a new channel with the configured propagation models
+   */
+  Ptr<CsmacaChannel> CreateChannel (void) const;
+  /**
+   * Install a device on each node, all attached to a new channel.
+   * Each device gets a newly allocated address.
+   */
+  NetDeviceContainer Install (NodeContainer c) const;
+  /**
+   * Install a device on each node, attached to the given channel.
+   */
+  NetDeviceContainer Install (NodeContainer c, Ptr<CsmacaChannel> channel) const;
+  /**
+   * Assign fixed random variable streams to the MACs and PHYs of the
+   * given devices.
+   *
+   * \return the number of streams assigned
+   */
+  int64_t AssignStreams (NetDeviceContainer c, int64_t stream) const;
+
+private:
+  ObjectFactory m_deviceFactory;
+  ObjectFactory m_macFactory;
+  ObjectFactory m_phyFactory;
+  ObjectFactory m_queueFactory;
+  bool m_setQueue;
+  ObjectFactory m_lossFactory;
+  ObjectFactory m_delayFactory;
+};
 
+} // namespace ns3
+
+#endif /* CSMACA_HELPER_H */
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "ns3/node.h"
+#include "ns3/csmaca-traffic-generator.h"
+#include "ns3/csmaca-traffic-sink.h"
+#include "csmaca-traffic-helper.h"
+
+namespace ns3 {
+
+CsmacaTrafficHelper::CsmacaTrafficHelper ()
+{
+  m_generatorFactory.SetTypeId ("ns3::CsmacaTrafficGenerator");
+  m_sinkFactory.SetTypeId ("ns3::CsmacaTrafficSink");
+}
+
+void
+CsmacaTrafficHelper::SetGeneratorAttribute (std::string n, const AttributeValue &v)
+{
+  m_generatorFactory.Set (n, v);
+}
+
+void
+CsmacaTrafficHelper::SetSinkAttribute (std::string n, const AttributeValue &v)
+{
+  m_sinkFactory.Set (n, v);
+}
+
+ApplicationContainer
+CsmacaTrafficHelper::InstallGenerator (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Application> app = m_generatorFactory.Create<Application> ();
+      (*i)->AddApplication (app);
+      apps.Add (app);
+    }
+  return apps;
+}
+
+ApplicationContainer
+CsmacaTrafficHelper::InstallSink (NodeContainer c) const
+{
+  ApplicationContainer apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Application> app = m_sinkFactory.Create<Application> ();
+      (*i)->AddApplication (app);
+      apps.Add (app);
+    }
+  return apps;
+}
+
+int64_t
+CsmacaTrafficHelper::AssignStreams (ApplicationContainer c, int64_t stream) const
+{
+  int64_t currentStream = stream;
+  for (ApplicationContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<CsmacaTrafficGenerator> generator = DynamicCast<CsmacaTrafficGenerator> (*i);
+      if (generator != 0)
+        {
+          currentStream += generator->AssignStreams (currentStream);
+        }
+    }
+  return currentStream - stream;
+}
+
+} // namespace ns3
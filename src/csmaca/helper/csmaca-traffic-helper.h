@@ -0,0 +1,64 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_TRAFFIC_HELPER_H
+#define CSMACA_TRAFFIC_HELPER_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/attribute.h"
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/application-container.h"
+
+namespace ns3 {
+
+/**
+ * Installs CsmacaTrafficGenerator and CsmacaTrafficSink applications.
+ */
+class CsmacaTrafficHelper
+{
+public:
+  CsmacaTrafficHelper ();
+
+  void SetGeneratorAttribute (std::string n, const AttributeValue &v);
+  void SetSinkAttribute (std::string n, const AttributeValue &v);
+
+  /**
+   * Install a generator sending through the first device of each node.
+   */
+  ApplicationContainer InstallGenerator (NodeContainer c) const;
+  ApplicationContainer InstallSink (NodeContainer c) const;
+  /**
+   * Assign fixed random variable streams to the generators among the
+   * given applications.
+   *
+   * \return the number of streams assigned
+   */
+  int64_t AssignStreams (ApplicationContainer c, int64_t stream) const;
+
+private:
+  ObjectFactory m_generatorFactory;
+  ObjectFactory m_sinkFactory;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_TRAFFIC_HELPER_H */
@@ -0,0 +1,265 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/object-factory.h"
+#include "csmaca-access-category.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaAccessCategory");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaAccessCategory);
+
+TypeId
+CsmacaAccessCategory::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaAccessCategory")
+    .SetParent<Object> ()
+    .AddConstructor<CsmacaAccessCategory> ()
+    .AddAttribute ("MinCw", "The minimum value of the contention window.",
+                   UintegerValue (15),
+                   MakeUintegerAccessor (&CsmacaAccessCategory::SetMinCw,
+                                         &CsmacaAccessCategory::GetMinCw),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxCw", "The maximum value of the contention window.",
+                   UintegerValue (1023),
+                   MakeUintegerAccessor (&CsmacaAccessCategory::SetMaxCw,
+                                         &CsmacaAccessCategory::GetMaxCw),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Aifsn", "The AIFS is SIFS + Aifsn slots.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&CsmacaAccessCategory::SetAifsn,
+                                         &CsmacaAccessCategory::GetAifsn),
+                   MakeUintegerChecker<uint32_t> (2, 15))
+    .AddAttribute ("TxopLimit", "Time during which queued frames are sent back to back "
+                   "after a successful channel access. 0 disables bursting.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&CsmacaAccessCategory::SetTxopLimit,
+                                     &CsmacaAccessCategory::GetTxopLimit),
+                   MakeTimeChecker ())
+    .AddAttribute ("CwPolicy", "The type of the policy which drives the contention window.",
+                   TypeIdValue (CsmacaBebCwPolicy::GetTypeId ()),
+                   MakeTypeIdAccessor (&CsmacaAccessCategory::SetCwPolicy,
+                                       &CsmacaAccessCategory::GetCwPolicyTypeId),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("QueueType", "The type of the queue: CsmacaCodelMacQueue or CsmacaFqCodelMacQueue "
+                   "for active queue management, CsmacaAirtimeMacQueue for airtime "
+                   "fairness between destinations.",
+                   TypeIdValue (CsmacaMacQueue::GetTypeId ()),
+                   MakeTypeIdAccessor (&CsmacaAccessCategory::SetQueueType,
+                                       &CsmacaAccessCategory::GetQueueTypeId),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("Queue", "The queue of the access category.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmacaAccessCategory::GetQueue),
+                   MakePointerChecker<CsmacaMacQueue> ())
+  ;
+  return tid;
+}
+
+CsmacaAccessCategory::CsmacaAccessCategory ()
+  : m_cwMin (15),
+    m_cwMax (1023),
+    m_cw (15),
+    m_aifsn (2),
+    m_txopLimit (Seconds (0)),
+    m_backoffEnd (Seconds (0))
+{
+  CSMACA_LOG_FUNCTION (this);
+  m_queue = CreateObject<CsmacaMacQueue> ();
+  m_cwPolicy = CreateObject<CsmacaBebCwPolicy> ();
+}
+
+CsmacaAccessCategory::~CsmacaAccessCategory ()
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+void
+CsmacaAccessCategory::DoDispose (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  m_queue = 0;
+  m_cwPolicy = 0;
+  Object::DoDispose ();
+}
+
+void
+CsmacaAccessCategory::SetQueue (Ptr<CsmacaMacQueue> queue)
+{
+  m_queue = queue;
+}
+
+Ptr<CsmacaMacQueue>
+CsmacaAccessCategory::GetQueue (void) const
+{
+  return m_queue;
+}
+
+void
+CsmacaAccessCategory::SetQueueType (TypeId tid)
+{
+  CSMACA_LOG_FUNCTION (this << tid);
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  m_queue = factory.Create<CsmacaMacQueue> ();
+}
+
+TypeId
+CsmacaAccessCategory::GetQueueTypeId (void) const
+{
+  return m_queue->GetInstanceTypeId ();
+}
+
+void
+CsmacaAccessCategory::SetMinCw (uint32_t minCw)
+{
+  CSMACA_LOG_FUNCTION (this << minCw);
+  bool changed = m_cwMin != minCw;
+  m_cwMin = minCw;
+  if (changed)
+    {
+      ResetCw ();
+    }
+}
+
+uint32_t
+CsmacaAccessCategory::GetMinCw (void) const
+{
+  return m_cwMin;
+}
+
+void
+CsmacaAccessCategory::SetMaxCw (uint32_t maxCw)
+{
+  CSMACA_LOG_FUNCTION (this << maxCw);
+  m_cwMax = maxCw;
+  m_cw = std::min (m_cw, m_cwMax);
+}
+
+uint32_t
+CsmacaAccessCategory::GetMaxCw (void) const
+{
+  return m_cwMax;
+}
+
+void
+CsmacaAccessCategory::SetAifsn (uint32_t aifsn)
+{
+  m_aifsn = aifsn;
+}
+
+uint32_t
+CsmacaAccessCategory::GetAifsn (void) const
+{
+  return m_aifsn;
+}
+
+void
+CsmacaAccessCategory::SetTxopLimit (Time txopLimit)
+{
+  m_txopLimit = txopLimit;
+}
+
+Time
+CsmacaAccessCategory::GetTxopLimit (void) const
+{
+  return m_txopLimit;
+}
+
+void
+CsmacaAccessCategory::SetCwPolicy (TypeId tid)
+{
+  CSMACA_LOG_FUNCTION (this << tid);
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  m_cwPolicy = factory.Create<CsmacaCwPolicy> ();
+  ResetCw ();
+}
+
+TypeId
+CsmacaAccessCategory::GetCwPolicyTypeId (void) const
+{
+  return m_cwPolicy->GetInstanceTypeId ();
+}
+
+Ptr<CsmacaCwPolicy>
+CsmacaAccessCategory::GetCwPolicy (void) const
+{
+  return m_cwPolicy;
+}
+
+uint32_t
+CsmacaAccessCategory::GetCw (void) const
+{
+  return m_cw;
+}
+
+void
+CsmacaAccessCategory::ResetCw (void)
+{
+  m_cw = m_cwMin;
+}
+
+void
+CsmacaAccessCategory::NotifySuccess (void)
+{
+  m_cw = m_cwPolicy->GetCwAfterSuccess (m_cw, m_cwMin, m_cwMax);
+  CSMACA_LOG_DEBUG ("success, cw=" << m_cw);
+}
+
+void
+CsmacaAccessCategory::NotifyFailure (void)
+{
+  m_cw = m_cwPolicy->GetCwAfterFailure (m_cw, m_cwMin, m_cwMax);
+  CSMACA_LOG_DEBUG ("failure, cw=" << m_cw);
+}
+
+void
+CsmacaAccessCategory::NotifyDrop (void)
+{
+  m_cw = m_cwPolicy->GetCwAfterDrop (m_cw, m_cwMin, m_cwMax);
+  CSMACA_LOG_DEBUG ("drop, cw=" << m_cw);
+}
+
+void
+CsmacaAccessCategory::NotifyTransmission (uint32_t idleSlots)
+{
+  m_cwPolicy->NotifyTransmission (idleSlots);
+}
+
+void
+CsmacaAccessCategory::SetBackoffEnd (Time end)
+{
+  m_backoffEnd = end;
+}
+
+Time
+CsmacaAccessCategory::GetBackoffEnd (void) const
+{
+  return m_backoffEnd;
+}
+
+} // namespace ns3
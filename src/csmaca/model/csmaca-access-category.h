@@ -0,0 +1,117 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_ACCESS_CATEGORY_H
+#define CSMACA_ACCESS_CATEGORY_H
+
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/type-id.h"
+#include "csmaca-mac-queue.h"
+#include "csmaca-cw-policy.h"
+
+namespace ns3 {
+
+/**
+ * The queue, the contention parameters and the contention window of
+ * one access category. Channel access itself is run by CsmacaMac; the
+ * evolution of the contention window is left to a CsmacaCwPolicy.
+ */
+class CsmacaAccessCategory : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaAccessCategory ();
+  ~CsmacaAccessCategory ();
+
+  void SetQueue (Ptr<CsmacaMacQueue> queue);
+  Ptr<CsmacaMacQueue> GetQueue (void) const;
+  /**
+   * Replace the queue by an empty one of the given type.
+   *
+   * \param tid the type of the queue, a subclass of CsmacaMacQueue
+   */
+  void SetQueueType (TypeId tid);
+  TypeId GetQueueTypeId (void) const;
+  void SetMinCw (uint32_t minCw);
+  uint32_t GetMinCw (void) const;
+  void SetMaxCw (uint32_t maxCw);
+  uint32_t GetMaxCw (void) const;
+  void SetAifsn (uint32_t aifsn);
+  uint32_t GetAifsn (void) const;
+  void SetTxopLimit (Time txopLimit);
+  Time GetTxopLimit (void) const;
+
+  /**
+   * \param tid the type of the policy which drives the contention window
+   */
+  void SetCwPolicy (TypeId tid);
+  TypeId GetCwPolicyTypeId (void) const;
+  Ptr<CsmacaCwPolicy> GetCwPolicy (void) const;
+
+  uint32_t GetCw (void) const;
+  /**
+   * Reset the contention window to its minimum
+   */
+  void ResetCw (void);
+  /**
+   * Update the contention window after an acknowledged transmission
+   */
+  void NotifySuccess (void);
+  /**
+   * Update the contention window after a failed transmission or an
+   * internal collision
+   */
+  void NotifyFailure (void);
+  /**
+   * Update the contention window after a frame is discarded
+   */
+  void NotifyDrop (void);
+  /**
+   * \param idleSlots the number of idle slots which preceded a
+   *        transmission heard on the medium
+   */
+  void NotifyTransmission (uint32_t idleSlots);
+
+  /**
+   * \param end the time at which the backoff drawn for the current
+   *        contention ends
+   */
+  void SetBackoffEnd (Time end);
+  Time GetBackoffEnd (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  Ptr<CsmacaMacQueue> m_queue;
+  Ptr<CsmacaCwPolicy> m_cwPolicy;
+  uint32_t m_cwMin;
+  uint32_t m_cwMax;
+  uint32_t m_cw;
+  uint32_t m_aifsn;
+  Time m_txopLimit;
+  Time m_backoffEnd;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_ACCESS_CATEGORY_H */
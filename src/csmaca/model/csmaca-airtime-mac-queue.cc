@@ -0,0 +1,305 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "ns3/log.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-airtime-mac-queue.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaAirtimeMacQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaAirtimeMacQueue);
+
+CsmacaAirtimeMacQueue::Station::Station ()
+  : deficit (Seconds (0)),
+    active (false)
+{
+}
+
+TypeId
+CsmacaAirtimeMacQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaAirtimeMacQueue")
+    .SetParent<CsmacaMacQueue> ()
+    .AddConstructor<CsmacaAirtimeMacQueue> ()
+    .AddAttribute ("AirtimeQuantum", "Medium time a destination may use in each round.",
+                   TimeValue (MicroSeconds (300)),
+                   MakeTimeAccessor (&CsmacaAirtimeMacQueue::m_quantum),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+CsmacaAirtimeMacQueue::CsmacaAirtimeMacQueue ()
+  : m_quantum (MicroSeconds (300)),
+    m_totalSize (0),
+    m_totalBytes (0)
+{
+}
+
+CsmacaAirtimeMacQueue::~CsmacaAirtimeMacQueue ()
+{
+}
+
+void
+CsmacaAirtimeMacQueue::DoDispose (void)
+{
+  m_stations.clear ();
+  m_active.clear ();
+  m_totalSize = 0;
+  m_totalBytes = 0;
+  CsmacaMacQueue::DoDispose ();
+}
+
+void
+CsmacaAirtimeMacQueue::SetMaxDelay (Time delay)
+{
+  CsmacaMacQueue::SetMaxDelay (delay);
+  for (std::map<Mac48Address, Station>::iterator it = m_stations.begin (); it != m_stations.end (); it++)
+    {
+      it->second.queue->SetMaxDelay (delay);
+    }
+}
+
+CsmacaAirtimeMacQueue::Station &
+CsmacaAirtimeMacQueue::GetStation (Mac48Address dest)
+{
+  Station &station = m_stations[dest];
+  if (station.queue == 0)
+    {
+      // The limits apply to the sum of the queues
+      station.queue = CreateObject<CsmacaMacQueue> ();
+      station.queue->SetMaxSize (0xffffffff);
+      station.queue->SetMaxBytes (0);
+      station.queue->SetMaxDelay (m_maxDelay);
+      station.queue->TraceConnectWithoutContext ("Expired",
+                                                 MakeCallback (&CsmacaAirtimeMacQueue::NotifyExpired, this));
+    }
+  return station;
+}
+
+void
+CsmacaAirtimeMacQueue::Activate (Mac48Address dest, Station &station)
+{
+  if (!station.active)
+    {
+      station.active = true;
+      // A station which overspent keeps its debt, otherwise a receiver
+      // with a single frame queued at a time would never pay it back
+      if (!station.deficit.IsNegative ())
+        {
+          station.deficit = Max (station.deficit, m_quantum);
+        }
+      m_active.push_back (dest);
+    }
+}
+
+void
+CsmacaAirtimeMacQueue::NotifyExpired (Ptr<const Packet> packet)
+{
+  NotifyRemoved (packet);
+  m_expiredTrace (packet);
+}
+
+void
+CsmacaAirtimeMacQueue::NotifyRemoved (Ptr<const Packet> packet)
+{
+  m_totalSize--;
+  m_totalBytes -= packet->GetSize ();
+}
+
+CsmacaAirtimeMacQueue::Station *
+CsmacaAirtimeMacQueue::SelectStation (void)
+{
+  while (!m_active.empty ())
+    {
+      Mac48Address dest = m_active.front ();
+      Station &station = m_stations[dest];
+      if (station.queue->IsEmpty ())
+        {
+          station.active = false;
+          m_active.pop_front ();
+          continue;
+        }
+      if (station.deficit.IsNegative ())
+        {
+          station.deficit += m_quantum;
+          m_active.pop_front ();
+          m_active.push_back (dest);
+          continue;
+        }
+      return &station;
+    }
+  return 0;
+}
+
+bool
+CsmacaAirtimeMacQueue::Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
+{
+  if (m_totalSize >= m_maxSize
+      || (m_maxBytes > 0 && m_totalBytes + packet->GetSize () > m_maxBytes))
+    {
+      m_dropTrace (packet);
+      return false;
+    }
+  Station &station = GetStation (hdr.GetAddr1 ());
+  station.queue->Enqueue (packet, hdr);
+  m_totalSize++;
+  m_totalBytes += packet->GetSize ();
+  Activate (hdr.GetAddr1 (), station);
+  return true;
+}
+
+void
+CsmacaAirtimeMacQueue::PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
+{
+  Station &station = GetStation (hdr.GetAddr1 ());
+  station.queue->PushFront (packet, hdr);
+  m_totalSize++;
+  m_totalBytes += packet->GetSize ();
+  Activate (hdr.GetAddr1 (), station);
+}
+
+Ptr<const Packet>
+CsmacaAirtimeMacQueue::Dequeue (CsmacaMacHeader *hdr)
+{
+  Station *station = SelectStation ();
+  if (station == 0)
+    {
+      return 0;
+    }
+  Ptr<const Packet> packet = station->queue->Dequeue (hdr);
+  if (packet != 0)
+    {
+      NotifyRemoved (packet);
+    }
+  return packet;
+}
+
+Ptr<const Packet>
+CsmacaAirtimeMacQueue::Peek (CsmacaMacHeader *hdr)
+{
+  Station *station = SelectStation ();
+  if (station == 0)
+    {
+      return 0;
+    }
+  return station->queue->Peek (hdr);
+}
+
+Ptr<const Packet>
+CsmacaAirtimeMacQueue::DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  std::map<Mac48Address, Station>::iterator it = m_stations.find (dest);
+  if (it == m_stations.end ())
+    {
+      return 0;
+    }
+  Ptr<const Packet> packet = it->second.queue->DequeueByAddress (hdr, dest);
+  if (packet != 0)
+    {
+      NotifyRemoved (packet);
+    }
+  return packet;
+}
+
+Ptr<const Packet>
+CsmacaAirtimeMacQueue::PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  std::map<Mac48Address, Station>::iterator it = m_stations.find (dest);
+  if (it == m_stations.end ())
+    {
+      return 0;
+    }
+  return it->second.queue->Peek (hdr);
+}
+
+bool
+CsmacaAirtimeMacQueue::Remove (Ptr<const Packet> packet)
+{
+  for (std::map<Mac48Address, Station>::iterator it = m_stations.begin (); it != m_stations.end (); it++)
+    {
+      if (it->second.queue->Remove (packet))
+        {
+          NotifyRemoved (packet);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+CsmacaAirtimeMacQueue::Flush (void)
+{
+  for (std::map<Mac48Address, Station>::iterator it = m_stations.begin (); it != m_stations.end (); it++)
+    {
+      it->second.queue->Flush ();
+      it->second.active = false;
+    }
+  m_active.clear ();
+  m_totalSize = 0;
+  m_totalBytes = 0;
+}
+
+bool
+CsmacaAirtimeMacQueue::IsEmpty (void)
+{
+  for (std::list<Mac48Address>::iterator it = m_active.begin (); it != m_active.end (); it++)
+    {
+      if (!m_stations[*it].queue->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t
+CsmacaAirtimeMacQueue::GetSize (void)
+{
+  return m_totalSize;
+}
+
+uint32_t
+CsmacaAirtimeMacQueue::GetNBytes (void) const
+{
+  return m_totalBytes;
+}
+
+void
+CsmacaAirtimeMacQueue::NotifyAirtime (Mac48Address dest, Time airtime)
+{
+  CSMACA_LOG_FUNCTION (this << dest << airtime);
+  std::map<Mac48Address, Station>::iterator it = m_stations.find (dest);
+  if (it != m_stations.end ())
+    {
+      it->second.deficit -= airtime;
+    }
+}
+
+bool
+CsmacaAirtimeMacQueue::IsScheduledPerDestination (void) const
+{
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,109 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_AIRTIME_MAC_QUEUE_H
+#define CSMACA_AIRTIME_MAC_QUEUE_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include "csmaca-mac-queue.h"
+
+namespace ns3 {
+
+/**
+ * One queue per destination, served by deficit round robin on airtime.
+ *
+ * Each destination with queued frames is in a round robin list. The MAC
+ * charges the medium time of every exchange, successful or not, to its
+ * destination through NotifyAirtime; a destination whose deficit is
+ * spent goes to the end of the list with AirtimeQuantum more. A
+ * destination whose queue empties keeps its deficit, debt included, so a
+ * slow or lossy receiver gets the same medium time as the others
+ * instead of the same number of frames.
+ *
+ * MaxPacketNumber and MaxBytes bound the sum of the queues, which is
+ * kept up to date on every enqueue, dequeue and drop. MaxDelay applies to
+ * every queue, including those which already exist when it is set.
+ */
+class CsmacaAirtimeMacQueue : public CsmacaMacQueue
+{
+public:
+  static TypeId GetTypeId (void);
+  CsmacaAirtimeMacQueue ();
+  ~CsmacaAirtimeMacQueue ();
+
+  virtual void SetMaxDelay (Time delay);
+  virtual bool Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual void PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual Ptr<const Packet> Dequeue (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> Peek (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
+  virtual Ptr<const Packet> PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
+  virtual bool Remove (Ptr<const Packet> packet);
+  virtual void Flush (void);
+  virtual bool IsEmpty (void);
+  virtual uint32_t GetSize (void);
+  virtual uint32_t GetNBytes (void) const;
+  virtual void NotifyAirtime (Mac48Address dest, Time airtime);
+  virtual bool IsScheduledPerDestination (void) const;
+
+private:
+  struct Station
+  {
+    Station ();
+    Ptr<CsmacaMacQueue> queue;
+    Time deficit;
+    bool active;
+  };
+
+  virtual void DoDispose (void);
+
+  /**
+   * \return the station of the destination, created if needed
+   */
+  Station &GetStation (Mac48Address dest);
+  /**
+   * Run the round robin up to the station which is served next.
+   *
+   * \return the station, or 0 if all queues are empty
+   */
+  Station *SelectStation (void);
+  /**
+   * Put a station back in the round robin. A negative deficit is kept.
+   */
+  void Activate (Mac48Address dest, Station &station);
+  void NotifyExpired (Ptr<const Packet> packet);
+  /**
+   * Account for a packet which left one of the queues.
+   */
+  void NotifyRemoved (Ptr<const Packet> packet);
+
+  Time m_quantum;
+
+  std::map<Mac48Address, Station> m_stations;
+  std::list<Mac48Address> m_active;
+  uint32_t m_totalSize; //!< Packets in all the queues
+  uint32_t m_totalBytes; //!< Bytes in all the queues
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_AIRTIME_MAC_QUEUE_H */
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "csmaca-ampdu-subframe-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaAmpduSubframeHeader);
+
+static const uint8_t CSMACA_AMPDU_SIGNATURE = 0x4E;
+
+CsmacaAmpduSubframeHeader::CsmacaAmpduSubframeHeader ()
+  : m_length (0),
+    m_crc (CalculateCrc (0)),
+    m_signature (CSMACA_AMPDU_SIGNATURE)
+{
+}
+
+CsmacaAmpduSubframeHeader::~CsmacaAmpduSubframeHeader ()
+{
+}
+
+TypeId
+CsmacaAmpduSubframeHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaAmpduSubframeHeader")
+    .SetParent<Header> ()
+    .AddConstructor<CsmacaAmpduSubframeHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CsmacaAmpduSubframeHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CsmacaAmpduSubframeHeader::Print (std::ostream &os) const
+{
+  os << "length=" << m_length << ", crc=" << (uint32_t)m_crc
+     << ", signature=" << (uint32_t)m_signature;
+}
+
+uint32_t
+CsmacaAmpduSubframeHeader::GetSerializedSize (void) const
+{
+  return CSMACA_AMPDU_DELIMITER_LENGTH;
+}
+
+void
+CsmacaAmpduSubframeHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteHtolsbU16 (m_length);
+  i.WriteU8 (m_crc);
+  i.WriteU8 (m_signature);
+}
+
+uint32_t
+CsmacaAmpduSubframeHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_length = i.ReadLsbtohU16 ();
+  m_crc = i.ReadU8 ();
+  m_signature = i.ReadU8 ();
+  return i.GetDistanceFrom (start);
+}
+
+void
+CsmacaAmpduSubframeHeader::SetLength (uint16_t length)
+{
+  m_length = length;
+  m_crc = CalculateCrc (length);
+}
+
+uint16_t
+CsmacaAmpduSubframeHeader::GetLength (void) const
+{
+  return m_length;
+}
+
+bool
+CsmacaAmpduSubframeHeader::IsValid (void) const
+{
+  return m_signature == CSMACA_AMPDU_SIGNATURE && m_crc == CalculateCrc (m_length);
+}
+
+uint8_t
+CsmacaAmpduSubframeHeader::CalculateCrc (uint16_t length) const
+{
+  // CRC-8, G(x) = x^8 + x^2 + x + 1
+  uint8_t crc = 0xff;
+  uint8_t bytes[2] = { static_cast<uint8_t> (length & 0xff),
+                       static_cast<uint8_t> (length >> 8) };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      crc ^= bytes[i];
+      for (uint32_t bit = 0; bit < 8; bit++)
+        {
+          crc = (crc & 0x80) ? static_cast<uint8_t> ((crc << 1) ^ 0x07) : static_cast<uint8_t> (crc << 1);
+        }
+    }
+  return ~crc;
+}
+
+} // namespace ns3
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_AMPDU_SUBFRAME_HEADER_H
+#define CSMACA_AMPDU_SUBFRAME_HEADER_H
+
+#include <stdint.h>
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * The length in octets of the MPDU delimiter
+ */
+static const uint16_t CSMACA_AMPDU_DELIMITER_LENGTH = 4;
+
+/**
+ * Implements the MPDU delimiter which precedes every subframe of an
+ * aggregated frame
+ *
+ * |Length|CRC|Signature|
+ *  Length:    16 [bits]
+ *  CRC:        8 [bits] (CRC-8 over the length field)
+ *  Signature:  8 [bits] (0x4E)
+ */
+class CsmacaAmpduSubframeHeader : public Header
+{
+public:
+  CsmacaAmpduSubframeHeader ();
+  ~CsmacaAmpduSubframeHeader ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  void SetLength (uint16_t length);
+  uint16_t GetLength (void) const;
+  /**
+   * \return true if the signature and the CRC of the delimiter are correct
+   */
+  bool IsValid (void) const;
+
+private:
+  uint8_t CalculateCrc (uint16_t length) const;
+
+  uint16_t m_length;
+  uint8_t m_crc;
+  uint8_t m_signature;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_AMPDU_SUBFRAME_HEADER_H */
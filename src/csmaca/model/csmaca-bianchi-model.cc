@@ -0,0 +1,218 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <cmath>
+#include "ns3/assert.h"
+#include "ns3/llc-snap-header.h"
+#include "csmaca-mac.h"
+#include "csmaca-mac-header.h"
+#include "csmaca-mac-trailer.h"
+#include "csmaca-preamble.h"
+#include "csmaca-bianchi-model.h"
+
+namespace ns3 {
+
+CsmacaBianchiModel::CsmacaBianchiModel ()
+  : m_sifs (MicroSeconds (16)),
+    m_difs (MicroSeconds (34)),
+    m_slotTime (MicroSeconds (9)),
+    m_propagationDelay (Seconds (1000.0 / 300000000.0)),
+    m_rate (6000000 / 8),
+    m_rtsThreshold (1000),
+    m_minCw (15),
+    m_maxCw (1023)
+{
+}
+
+void
+CsmacaBianchiModel::ReadFrom (Ptr<CsmacaMac> mac)
+{
+  m_sifs = mac->GetSifs ();
+  m_difs = mac->GetDifs ();
+  m_slotTime = mac->GetSlotTime ();
+  m_propagationDelay = mac->GetMaxPropagationDelay ();
+  m_rate = mac->GetRate ();
+  m_rtsThreshold = mac->GetRtsThreshold ();
+  Ptr<CsmacaAccessCategory> ac = mac->GetAccessCategory (CSMACA_AC_BE);
+  m_minCw = ac->GetMinCw ();
+  m_maxCw = ac->GetMaxCw ();
+}
+
+void
+CsmacaBianchiModel::SetSifs (Time sifs)
+{
+  m_sifs = sifs;
+}
+
+void
+CsmacaBianchiModel::SetDifs (Time difs)
+{
+  m_difs = difs;
+}
+
+void
+CsmacaBianchiModel::SetSlotTime (Time slotTime)
+{
+  m_slotTime = slotTime;
+}
+
+void
+CsmacaBianchiModel::SetPropagationDelay (Time delay)
+{
+  m_propagationDelay = delay;
+}
+
+void
+CsmacaBianchiModel::SetRate (uint32_t rate)
+{
+  m_rate = rate;
+}
+
+void
+CsmacaBianchiModel::SetRtsThreshold (uint32_t threshold)
+{
+  m_rtsThreshold = threshold;
+}
+
+void
+CsmacaBianchiModel::SetCw (uint32_t minCw, uint32_t maxCw)
+{
+  NS_ASSERT (minCw <= maxCw);
+  m_minCw = minCw;
+  m_maxCw = maxCw;
+}
+
+double
+CsmacaBianchiModel::GetTransmissionProbability (uint32_t stations) const
+{
+  NS_ASSERT (stations > 0);
+  double w = m_minCw + 1;
+  // Number of doublings of the window up to its maximum
+  uint32_t m = static_cast<uint32_t> (std::floor (std::log ((m_maxCw + 1.0) / w) / std::log (2.0) + 0.5));
+  // tau (p) = 2 / (1 + W + p W sum_{i<m} (2p)^i) decreases with p, and
+  // p (tau) = 1 - (1 - tau)^(n-1) increases with tau: bisect on tau
+  double low = 0;
+  double high = 1;
+  for (uint32_t iteration = 0; iteration < 100; iteration++)
+    {
+      double tau = (low + high) / 2;
+      double p = 1 - std::pow (1 - tau, static_cast<double> (stations - 1));
+      double sum = 0;
+      double power = 1;
+      for (uint32_t i = 0; i < m; i++)
+        {
+          sum += power;
+          power *= 2 * p;
+        }
+      double fixed = 2 / (1 + w + p * w * sum);
+      if (fixed > tau)
+        {
+          low = tau;
+        }
+      else
+        {
+          high = tau;
+        }
+    }
+  return (low + high) / 2;
+}
+
+double
+CsmacaBianchiModel::GetCollisionProbability (uint32_t stations) const
+{
+  double tau = GetTransmissionProbability (stations);
+  return 1 - std::pow (1 - tau, static_cast<double> (stations - 1));
+}
+
+Time
+CsmacaBianchiModel::GetControlFrameTime (uint32_t size) const
+{
+  // Control frames use the default preamble rate, as in CsmacaMac
+  CsmacaPreamble preamble;
+  CsmacaMacTrailer fcs;
+  return Seconds (double (size + fcs.GetSize ()) / preamble.GetRate ()) + preamble.GetDuration ();
+}
+
+bool
+CsmacaBianchiModel::NeedRts (uint32_t payloadSize) const
+{
+  LlcSnapHeader llc;
+  return m_rtsThreshold <= payloadSize + llc.GetSerializedSize ();
+}
+
+Time
+CsmacaBianchiModel::GetSuccessTime (uint32_t payloadSize) const
+{
+  CsmacaMacHeader data;
+  data.SetType (CSMACA_MAC_DATA);
+  CsmacaMacHeader ack;
+  ack.SetType (CSMACA_MAC_ACK);
+  LlcSnapHeader llc;
+  CsmacaMacTrailer fcs;
+  CsmacaPreamble preamble;
+  uint32_t size = data.GetSize () + llc.GetSerializedSize () + payloadSize + fcs.GetSize ();
+  Time dataTime = Seconds (double (size) / m_rate) + preamble.GetDuration () + m_propagationDelay;
+  Time time = dataTime + m_sifs + GetControlFrameTime (ack.GetSize ()) + m_propagationDelay + m_difs;
+  if (NeedRts (payloadSize))
+    {
+      CsmacaMacHeader rts;
+      rts.SetType (CSMACA_MAC_RTS);
+      CsmacaMacHeader cts;
+      cts.SetType (CSMACA_MAC_CTS);
+      time += GetControlFrameTime (rts.GetSize ()) + m_propagationDelay + m_sifs
+        + GetControlFrameTime (cts.GetSize ()) + m_propagationDelay + m_sifs;
+    }
+  return time;
+}
+
+Time
+CsmacaBianchiModel::GetCollisionTime (uint32_t payloadSize) const
+{
+  if (NeedRts (payloadSize))
+    {
+      CsmacaMacHeader rts;
+      rts.SetType (CSMACA_MAC_RTS);
+      return GetControlFrameTime (rts.GetSize ()) + m_propagationDelay + m_difs;
+    }
+  CsmacaMacHeader data;
+  data.SetType (CSMACA_MAC_DATA);
+  LlcSnapHeader llc;
+  CsmacaMacTrailer fcs;
+  CsmacaPreamble preamble;
+  uint32_t size = data.GetSize () + llc.GetSerializedSize () + payloadSize + fcs.GetSize ();
+  return Seconds (double (size) / m_rate) + preamble.GetDuration () + m_propagationDelay + m_difs;
+}
+
+double
+CsmacaBianchiModel::GetThroughput (uint32_t stations, uint32_t payloadSize) const
+{
+  double tau = GetTransmissionProbability (stations);
+  double n = stations;
+  // Probability that at least one station transmits in a slot, and that
+  // exactly one does given that one does
+  double transmission = 1 - std::pow (1 - tau, n);
+  double success = n * tau * std::pow (1 - tau, n - 1) / transmission;
+  double slot = (1 - transmission) * m_slotTime.GetSeconds ()
+    + transmission * success * GetSuccessTime (payloadSize).GetSeconds ()
+    + transmission * (1 - success) * GetCollisionTime (payloadSize).GetSeconds ();
+  return transmission * success * payloadSize * 8 / slot;
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_BIANCHI_MODEL_H
+#define CSMACA_BIANCHI_MODEL_H
+
+#include <stdint.h>
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class CsmacaMac;
+
+/**
+ * Saturation throughput of n stations in range of each other, from the
+ * Markov chain model of G. Bianchi, "Performance analysis of the IEEE
+ * 802.11 distributed coordination function", IEEE JSAC 18(3), 2000.
+ *
+ * The timings default to those of CsmacaMac, and ReadFrom copies them
+ * from a configured MAC and its best effort access category. As in the
+ * MAC, frames whose MSDU is at least RtsThreshold bytes long are sent
+ * after an RTS/CTS exchange, the other ones with basic access.
+ */
+class CsmacaBianchiModel
+{
+public:
+  CsmacaBianchiModel ();
+
+  /**
+   * Copy the timings, rate, RTS threshold and contention window bounds
+   * of the given MAC.
+   */
+  void ReadFrom (Ptr<CsmacaMac> mac);
+
+  void SetSifs (Time sifs);
+  void SetDifs (Time difs);
+  void SetSlotTime (Time slotTime);
+  void SetPropagationDelay (Time delay);
+  /**
+   * \param rate the rate of data frames in bytes per second
+   */
+  void SetRate (uint32_t rate);
+  void SetRtsThreshold (uint32_t threshold);
+  void SetCw (uint32_t minCw, uint32_t maxCw);
+
+  /**
+   * \return the probability tau that a station transmits in a slot
+   */
+  double GetTransmissionProbability (uint32_t stations) const;
+  /**
+   * \return the probability p that a transmission collides
+   */
+  double GetCollisionProbability (uint32_t stations) const;
+  /**
+   * \param stations the number of saturated stations
+   * \param payloadSize the size in bytes of the packets given to the device
+   * \return the saturation throughput in payload bits per second
+   */
+  double GetThroughput (uint32_t stations, uint32_t payloadSize) const;
+
+  /**
+   * \return the time the medium is busy for a successful transmission,
+   *         including the DIFS which follows it
+   */
+  Time GetSuccessTime (uint32_t payloadSize) const;
+  /**
+   * \return the time the medium is busy for a collision, including the
+   *         DIFS which follows it
+   */
+  Time GetCollisionTime (uint32_t payloadSize) const;
+
+private:
+  Time GetControlFrameTime (uint32_t size) const;
+  bool NeedRts (uint32_t payloadSize) const;
+
+  Time m_sifs;
+  Time m_difs;
+  Time m_slotTime;
+  Time m_propagationDelay;
+  uint32_t m_rate;
+  uint32_t m_rtsThreshold;
+  uint32_t m_minCw;
+  uint32_t m_maxCw;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_BIANCHI_MODEL_H */
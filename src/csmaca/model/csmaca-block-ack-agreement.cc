@@ -0,0 +1,175 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "ns3/log.h"
+#include "csmaca-block-ack-agreement.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaBlockAckAgreement");
+
+namespace ns3 {
+
+/***********************************
+ *          Originator
+ ***********************************/
+
+CsmacaOriginatorBlockAckAgreement::CsmacaOriginatorBlockAckAgreement ()
+  : m_established (false),
+    m_needBlockAckReq (false)
+{
+}
+
+bool
+CsmacaOriginatorBlockAckAgreement::IsEstablished (void) const
+{
+  return m_established;
+}
+
+bool
+CsmacaOriginatorBlockAckAgreement::NeedBlockAckReq (void) const
+{
+  return !m_established || m_needBlockAckReq;
+}
+
+void
+CsmacaOriginatorBlockAckAgreement::NotifyBlockAckReceived (void)
+{
+  m_established = true;
+  m_needBlockAckReq = false;
+}
+
+void
+CsmacaOriginatorBlockAckAgreement::NotifyAcked (uint16_t seq)
+{
+  m_retries.erase (seq);
+}
+
+uint32_t
+CsmacaOriginatorBlockAckAgreement::NotifyMissed (uint16_t seq)
+{
+  return ++m_retries[seq];
+}
+
+void
+CsmacaOriginatorBlockAckAgreement::NotifyDiscarded (uint16_t seq)
+{
+  CSMACA_LOG_FUNCTION (this << seq);
+  m_retries.erase (seq);
+  m_needBlockAckReq = true;
+}
+
+/***********************************
+ *          Recipient
+ ***********************************/
+
+CsmacaRecipientBlockAckAgreement::CsmacaRecipientBlockAckAgreement (uint16_t startingSeq)
+  : m_winStart (startingSeq & 0x0fff),
+    m_buffer (CSMACA_BLOCK_ACK_WINDOW_SIZE),
+    m_received (CSMACA_BLOCK_ACK_WINDOW_SIZE, false)
+{
+}
+
+bool
+CsmacaRecipientBlockAckAgreement::NotifyReceivedMpdu (Ptr<Packet> packet, const CsmacaMacHeader &hdr,
+                                                      Mpdus *released)
+{
+  CSMACA_LOG_FUNCTION (this << packet << hdr.GetSequenceNumber () << m_winStart);
+  uint16_t seq = hdr.GetSequenceNumber ();
+  if (CsmacaIsOldSequence (seq, m_winStart))
+    {
+      CSMACA_LOG_DEBUG ("duplicate, seq=" << seq << " is older than the window");
+      return false;
+    }
+  if (CsmacaGetSequenceDistance (seq, m_winStart) >= CSMACA_BLOCK_ACK_WINDOW_SIZE)
+    {
+      // the originator gave up older MPDUs: slide the window so that seq is its last entry
+      FlushUpTo ((seq - CSMACA_BLOCK_ACK_WINDOW_SIZE + 1) & 0x0fff, released);
+    }
+  uint16_t slot = seq % CSMACA_BLOCK_ACK_WINDOW_SIZE;
+  if (m_received[slot])
+    {
+      CSMACA_LOG_DEBUG ("duplicate, seq=" << seq << " is already buffered");
+      return false;
+    }
+  m_received[slot] = true;
+  m_buffer[slot] = std::make_pair (packet, hdr);
+  ReleaseInOrder (released);
+  return true;
+}
+
+void
+CsmacaRecipientBlockAckAgreement::NotifyBlockAckReq (uint16_t startingSeq, Mpdus *released)
+{
+  CSMACA_LOG_FUNCTION (this << startingSeq << m_winStart);
+  startingSeq &= 0x0fff;
+  if (startingSeq != m_winStart && !CsmacaIsOldSequence (startingSeq, m_winStart))
+    {
+      FlushUpTo (startingSeq, released);
+    }
+  ReleaseInOrder (released);
+}
+
+void
+CsmacaRecipientBlockAckAgreement::FillBlockAck (CsmacaBlockAckHeader *blockAck) const
+{
+  blockAck->SetStartingSequence (m_winStart);
+  for (uint16_t i = 0; i < CSMACA_BLOCK_ACK_WINDOW_SIZE; i++)
+    {
+      uint16_t seq = (m_winStart + i) & 0x0fff;
+      if (m_received[seq % CSMACA_BLOCK_ACK_WINDOW_SIZE])
+        {
+          blockAck->SetReceivedPacket (seq);
+        }
+    }
+}
+
+void
+CsmacaRecipientBlockAckAgreement::FlushUpTo (uint16_t newWinStart, Mpdus *released)
+{
+  uint16_t distance = CsmacaGetSequenceDistance (newWinStart, m_winStart);
+  uint16_t n = distance < CSMACA_BLOCK_ACK_WINDOW_SIZE ? distance : CSMACA_BLOCK_ACK_WINDOW_SIZE;
+  for (uint16_t i = 0; i < n; i++)
+    {
+      uint16_t slot = (m_winStart + i) % CSMACA_BLOCK_ACK_WINDOW_SIZE;
+      if (m_received[slot])
+        {
+          released->push_back (m_buffer[slot]);
+          m_buffer[slot].first = 0;
+          m_received[slot] = false;
+        }
+    }
+  m_winStart = newWinStart;
+}
+
+void
+CsmacaRecipientBlockAckAgreement::ReleaseInOrder (Mpdus *released)
+{
+  uint16_t slot = m_winStart % CSMACA_BLOCK_ACK_WINDOW_SIZE;
+  while (m_received[slot])
+    {
+      released->push_back (m_buffer[slot]);
+      m_buffer[slot].first = 0;
+      m_received[slot] = false;
+      m_winStart = (m_winStart + 1) & 0x0fff;
+      slot = m_winStart % CSMACA_BLOCK_ACK_WINDOW_SIZE;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_BLOCK_ACK_AGREEMENT_H
+#define CSMACA_BLOCK_ACK_AGREEMENT_H
+
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+#include "ns3/packet.h"
+#include "csmaca-mac-header.h"
+#include "csmaca-ctrl-headers.h"
+
+namespace ns3 {
+
+/**
+ * The number of MPDUs covered by a BlockAck bitmap, and so the largest
+ * span of sequence numbers the originator may have outstanding.
+ */
+static const uint16_t CSMACA_BLOCK_ACK_WINDOW_SIZE = 64;
+
+/**
+ * \return the distance from start to seq in the 12 bit sequence number space
+ */
+inline uint16_t
+CsmacaGetSequenceDistance (uint16_t seq, uint16_t start)
+{
+  return (seq - start) & 0x0fff;
+}
+
+/**
+ * \return true if seq lies in the half of the sequence number space
+ *         preceding start
+ */
+inline bool
+CsmacaIsOldSequence (uint16_t seq, uint16_t start)
+{
+  return CsmacaGetSequenceDistance (seq, start) >= 2048;
+}
+
+/**
+ * The originator side of a block ack agreement with one recipient.
+ *
+ * There is no ADDBA handshake: the agreement is opened by the
+ * BlockAckReq carried at the head of the first aggregated frame and is
+ * established once a BlockAck comes back. The scoreboard counts the
+ * transmissions of every MPDU which has not been acknowledged yet.
+ */
+class CsmacaOriginatorBlockAckAgreement
+{
+public:
+  CsmacaOriginatorBlockAckAgreement ();
+
+  bool IsEstablished (void) const;
+  /**
+   * \return true if the next aggregated frame must start with a
+   *         BlockAckReq, either to open the agreement or to move the
+   *         window of the recipient past discarded MPDUs
+   */
+  bool NeedBlockAckReq (void) const;
+  void NotifyBlockAckReceived (void);
+  /**
+   * \param seq the sequence number of an acknowledged MPDU
+   */
+  void NotifyAcked (uint16_t seq);
+  /**
+   * \param seq the sequence number of an MPDU missing from a BlockAck
+   * \return the number of failed transmissions of the MPDU so far
+   */
+  uint32_t NotifyMissed (uint16_t seq);
+  /**
+   * The MPDU is given up: the recipient has to be told to move on.
+   *
+   * \param seq the sequence number of the discarded MPDU
+   */
+  void NotifyDiscarded (uint16_t seq);
+
+private:
+  bool m_established;
+  bool m_needBlockAckReq;
+  std::map<uint16_t, uint32_t> m_retries;
+};
+
+/**
+ * The recipient side of a block ack agreement with one originator.
+ *
+ * Received MPDUs are kept in a reordering buffer covering the window
+ * [winStart, winStart + 63] and are released to the upper layer in
+ * sequence order. MPDUs older than the window are duplicates.
+ */
+class CsmacaRecipientBlockAckAgreement
+{
+public:
+  typedef std::list<std::pair<Ptr<Packet>, CsmacaMacHeader> > Mpdus;
+
+  /**
+   * \param startingSeq the starting sequence of the opening BlockAckReq
+   */
+  CsmacaRecipientBlockAckAgreement (uint16_t startingSeq);
+
+  /**
+   * \param packet the MSDU carried by the MPDU
+   * \param hdr the header of the MPDU
+   * \param released MPDUs which become in order are appended to this list
+   * \return false if the MPDU is a duplicate
+   */
+  bool NotifyReceivedMpdu (Ptr<Packet> packet, const CsmacaMacHeader &hdr, Mpdus *released);
+  /**
+   * \param startingSeq the starting sequence of a BlockAckReq
+   * \param released MPDUs released by moving the window are appended to this list
+   */
+  void NotifyBlockAckReq (uint16_t startingSeq, Mpdus *released);
+  /**
+   * \param blockAck the BlockAck to fill with the scoreboard of the window
+   */
+  void FillBlockAck (CsmacaBlockAckHeader *blockAck) const;
+
+private:
+  void FlushUpTo (uint16_t newWinStart, Mpdus *released);
+  void ReleaseInOrder (Mpdus *released);
+
+  uint16_t m_winStart;
+  std::vector<std::pair<Ptr<Packet>, CsmacaMacHeader> > m_buffer;
+  std::vector<bool> m_received;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_BLOCK_ACK_AGREEMENT_H */
@@ -20,11 +20,13 @@
 
 #include "csmaca-channel.h"
 #include "csmaca-net-device.h"
+#include "csmaca-counters.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaChannel");
 
@@ -44,7 +46,7 @@ CsmacaChannel::GetTypeId (void)
   
 CsmacaChannel::CsmacaChannel ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   ObjectFactory factoryLoss;
   factoryLoss.SetTypeId ("ns3::LogDistancePropagationLossModel");
@@ -72,7 +74,7 @@ CsmacaChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
 uint32_t
 CsmacaChannel::GetNDevices (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return m_phyList.size ();
 }
 
@@ -91,7 +93,8 @@ CsmacaChannel::Add (Ptr<CsmacaPhy> phy)
 void
 CsmacaChannel::Send (Ptr<Packet> packet, CsmacaPreamble preamble, double txPowerDbm, Ptr<CsmacaPhy> sender) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
+  CSMACA_COUNT (CHANNEL_FRAMES_SENT);
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
@@ -104,6 +107,7 @@ CsmacaChannel::Send (Ptr<Packet> packet, CsmacaPreamble preamble, double txPower
       Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
       double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
       Ptr<Packet> copy = packet->Copy ();
+      CSMACA_COUNT (CHANNEL_ALLOCATIONS);
       Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
       uint32_t dstNode;
       if (dstNetDevice == 0)
@@ -114,7 +118,8 @@ CsmacaChannel::Send (Ptr<Packet> packet, CsmacaPreamble preamble, double txPower
 	{
 	  dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
 	}
-      NS_LOG_DEBUG ("rxPower=" << rxPowerDbm << ", delay=" << delay);
+      CSMACA_LOG_DEBUG ("rxPower=" << rxPowerDbm << ", delay=" << delay);
+      CSMACA_COUNT (CHANNEL_EVENTS_SCHEDULED);
       Simulator::ScheduleWithContext (dstNode,
 				      delay,
 				      &CsmacaChannel::Receive,
@@ -129,7 +134,8 @@ CsmacaChannel::Send (Ptr<Packet> packet, CsmacaPreamble preamble, double txPower
 void
 CsmacaChannel::Receive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxPowerDbm, uint32_t i) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
+  CSMACA_COUNT (CHANNEL_FRAMES_DELIVERED);
   m_phyList[i]->StartReceive (packet, preamble, rxPowerDbm);
 }
 
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-codel-mac-queue.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaCodelMacQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaCodelMacQueue);
+
+TypeId
+CsmacaCodelMacQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaCodelMacQueue")
+    .SetParent<CsmacaMacQueue> ()
+    .AddConstructor<CsmacaCodelMacQueue> ()
+    .AddAttribute ("Target", "Acceptable standing sojourn time.",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&CsmacaCodelMacQueue::m_target),
+                   MakeTimeChecker ())
+    .AddAttribute ("Interval", "Time the sojourn time must stay above Target before dropping starts.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&CsmacaCodelMacQueue::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinBytes", "No frame is dropped while the queue holds at most this number of bytes.",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&CsmacaCodelMacQueue::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("CodelDrop", "A packet has been dropped by CoDel",
+                     MakeTraceSourceAccessor (&CsmacaCodelMacQueue::m_codelDropTrace))
+  ;
+  return tid;
+}
+
+CsmacaCodelMacQueue::CsmacaCodelMacQueue ()
+  : m_target (MilliSeconds (5)),
+    m_interval (MilliSeconds (100)),
+    m_minBytes (1500),
+    m_dropping (false),
+    m_firstAboveTime (Seconds (0)),
+    m_dropNext (Seconds (0)),
+    m_count (0),
+    m_lastCount (0)
+{
+}
+
+CsmacaCodelMacQueue::~CsmacaCodelMacQueue ()
+{
+}
+
+void
+CsmacaCodelMacQueue::SetTarget (Time target)
+{
+  m_target = target;
+}
+
+void
+CsmacaCodelMacQueue::SetInterval (Time interval)
+{
+  m_interval = interval;
+}
+
+Ptr<const Packet>
+CsmacaCodelMacQueue::Dequeue (CsmacaMacHeader *hdr)
+{
+  Cleanup ();
+  CheckFront ();
+  return CsmacaMacQueue::Dequeue (hdr);
+}
+
+Ptr<const Packet>
+CsmacaCodelMacQueue::Peek (CsmacaMacHeader *hdr)
+{
+  Cleanup ();
+  CheckFront ();
+  return CsmacaMacQueue::Peek (hdr);
+}
+
+void
+CsmacaCodelMacQueue::Flush (void)
+{
+  CsmacaMacQueue::Flush ();
+  m_dropping = false;
+  m_firstAboveTime = Seconds (0);
+}
+
+Ptr<const Packet>
+CsmacaCodelMacQueue::DropFront (void)
+{
+  if (m_size == 0)
+    {
+      return 0;
+    }
+  Ptr<const Packet> packet = At (0).packet;
+  PopFront ();
+  return packet;
+}
+
+Ptr<const Packet>
+CsmacaCodelMacQueue::DropNewest (void)
+{
+  uint32_t i = m_size;
+  while (i > 0 && At (i - 1).hdr.IsRetry ())
+    {
+      i--;
+    }
+  if (i == 0)
+    {
+      return 0;
+    }
+  i--;
+  Ptr<const Packet> packet = At (i).packet;
+  m_bytes -= packet->GetSize ();
+  // Move the newer frames forward, usually none
+  for (; i + 1 < m_size; i++)
+    {
+      Item &item = At (i);
+      Item &next = At (i + 1);
+      item.packet = next.packet;
+      item.hdr = next.hdr;
+      item.tstamp = next.tstamp;
+    }
+  At (m_size - 1).packet = 0;
+  m_size--;
+  return packet;
+}
+
+Time
+CsmacaCodelMacQueue::ControlLaw (Time t) const
+{
+  return t + Seconds (m_interval.GetSeconds () / std::sqrt ((double)m_count));
+}
+
+bool
+CsmacaCodelMacQueue::OkToDrop (Time now)
+{
+  if (m_size == 0)
+    {
+      m_firstAboveTime = Seconds (0);
+      return false;
+    }
+  Time sojourn = now - At (0).tstamp;
+  if (sojourn < m_target || m_bytes <= m_minBytes)
+    {
+      m_firstAboveTime = Seconds (0);
+      return false;
+    }
+  if (m_firstAboveTime.IsZero ())
+    {
+      m_firstAboveTime = now + m_interval;
+      return false;
+    }
+  return now >= m_firstAboveTime && m_size > 1 && !At (0).hdr.IsRetry ();
+}
+
+void
+CsmacaCodelMacQueue::CheckFront (void)
+{
+  Time now = Simulator::Now ();
+  bool okToDrop = OkToDrop (now);
+  if (m_dropping)
+    {
+      if (!okToDrop)
+        {
+          m_dropping = false;
+        }
+      while (m_dropping && now >= m_dropNext)
+        {
+          CSMACA_LOG_DEBUG ("drop, count=" << m_count);
+          m_codelDropTrace (DropFront ());
+          m_count++;
+          if (!OkToDrop (now))
+            {
+              m_dropping = false;
+            }
+          else
+            {
+              m_dropNext = ControlLaw (m_dropNext);
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      CSMACA_LOG_DEBUG ("drop, start dropping");
+      m_codelDropTrace (DropFront ());
+      m_dropping = true;
+      // Resume near the previous drop rate if dropping stopped recently
+      uint32_t delta = m_count - m_lastCount;
+      if (delta > 1 && now - m_dropNext < 16 * m_interval)
+        {
+          m_count = delta;
+        }
+      else
+        {
+          m_count = 1;
+        }
+      m_dropNext = ControlLaw (now);
+      m_lastCount = m_count;
+    }
+}
+
+} // namespace ns3
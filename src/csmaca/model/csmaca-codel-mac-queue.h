@@ -0,0 +1,96 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_CODEL_MAC_QUEUE_H
+#define CSMACA_CODEL_MAC_QUEUE_H
+
+#include "csmaca-mac-queue.h"
+
+namespace ns3 {
+
+/**
+ * CsmacaMacQueue with CoDel active queue management (RFC 8289).
+ *
+ * The sojourn time of the frame at the front is checked whenever a
+ * frame is about to leave the queue, from Peek as well as Dequeue, so
+ * that Dequeue returns the frame Peek has shown. Once the sojourn time
+ * stays above Target for Interval, frames are dropped from the front at
+ * a rate growing with the square root of the number of drops.
+ *
+ * Retransmissions, which already hold a sequence number, and the last
+ * frame of the queue are never dropped.
+ */
+class CsmacaCodelMacQueue : public CsmacaMacQueue
+{
+public:
+  static TypeId GetTypeId (void);
+  CsmacaCodelMacQueue ();
+  ~CsmacaCodelMacQueue ();
+
+  void SetTarget (Time target);
+  void SetInterval (Time interval);
+
+  virtual Ptr<const Packet> Dequeue (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> Peek (CsmacaMacHeader *hdr);
+  virtual void Flush (void);
+
+  /**
+   * Remove the frame at the front without running the control law.
+   *
+   * \return the frame, or 0 if the queue is empty
+   */
+  Ptr<const Packet> DropFront (void);
+  /**
+   * Remove the newest frame which is not a retransmission. Retransmissions
+   * already hold a sequence number which the recipient waits for.
+   *
+   * \return the frame, or 0 if the queue only holds retransmissions
+   */
+  Ptr<const Packet> DropNewest (void);
+
+private:
+  /**
+   * Run the control law on the frame at the front and drop it and the
+   * following ones while CoDel asks for it.
+   */
+  void CheckFront (void);
+  /**
+   * \param now the current time
+   * \return true if the frame at the front may be dropped
+   */
+  bool OkToDrop (Time now);
+  Time ControlLaw (Time t) const;
+
+  Time m_target;
+  Time m_interval;
+  uint32_t m_minBytes;
+
+  bool m_dropping;
+  Time m_firstAboveTime;
+  Time m_dropNext;
+  uint32_t m_count;
+  uint32_t m_lastCount;
+
+  TracedCallback<Ptr<const Packet> > m_codelDropTrace;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_CODEL_MAC_QUEUE_H */
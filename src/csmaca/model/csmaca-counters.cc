@@ -0,0 +1,98 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "csmaca-counters.h"
+
+namespace ns3 {
+
+uint64_t CsmacaCounters::m_counters[CsmacaCounters::COUNTER_COUNT] = { 0 };
+
+bool
+CsmacaCounters::IsEnabled (void)
+{
+#ifdef CSMACA_COUNTERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t
+CsmacaCounters::Get (enum Counter counter)
+{
+  return m_counters[counter];
+}
+
+const char *
+CsmacaCounters::GetName (enum Counter counter)
+{
+  switch (counter)
+    {
+    case CHANNEL_FRAMES_SENT:
+      return "ChannelFramesSent";
+    case CHANNEL_FRAMES_DELIVERED:
+      return "ChannelFramesDelivered";
+    case CHANNEL_EVENTS_SCHEDULED:
+      return "ChannelEventsScheduled";
+    case CHANNEL_ALLOCATIONS:
+      return "ChannelAllocations";
+    case PHY_RECEPTIONS_STARTED:
+      return "PhyReceptionsStarted";
+    case PHY_RECEPTIONS_CULLED:
+      return "PhyReceptionsCulled";
+    case PHY_EVENTS_SCHEDULED:
+      return "PhyEventsScheduled";
+    case INTERFERENCE_EVENTS_ADDED:
+      return "InterferenceEventsAdded";
+    case INTERFERENCE_SNR_PER_CALCULATIONS:
+      return "InterferenceSnrPerCalculations";
+    case INTERFERENCE_NI_CHANGES_MAX:
+      return "InterferenceNiChangesMax";
+    case INTERFERENCE_ALLOCATIONS:
+      return "InterferenceAllocations";
+    case MAC_EVENTS_SCHEDULED:
+      return "MacEventsScheduled";
+    case MAC_ALLOCATIONS:
+      return "MacAllocations";
+    case COUNTER_COUNT:
+      break;
+    }
+  return "";
+}
+
+void
+CsmacaCounters::Reset (void)
+{
+  for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+    {
+      m_counters[i] = 0;
+    }
+}
+
+void
+CsmacaCounters::Print (std::ostream &os)
+{
+  for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+    {
+      os << GetName (static_cast<enum Counter> (i)) << " " << m_counters[i] << std::endl;
+    }
+}
+
+} // namespace ns3
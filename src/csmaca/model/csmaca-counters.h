@@ -0,0 +1,104 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_COUNTERS_H
+#define CSMACA_COUNTERS_H
+
+#include <stdint.h>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * Counters of the work done on the hot paths of the channel, the PHY,
+ * the interference helper and the MAC, shared by all the devices of
+ * the simulation.
+ *
+ * The counters are only compiled in when CSMACA_COUNTERS is defined,
+ * which "./waf configure --enable-csmaca-counters" does. Otherwise the
+ * CSMACA_COUNT macros expand to nothing and every counter reads 0.
+ */
+class CsmacaCounters
+{
+public:
+  enum Counter
+  {
+    CHANNEL_FRAMES_SENT,
+    CHANNEL_FRAMES_DELIVERED,
+    CHANNEL_EVENTS_SCHEDULED,
+    CHANNEL_ALLOCATIONS,
+    PHY_RECEPTIONS_STARTED,
+    PHY_RECEPTIONS_CULLED,
+    PHY_EVENTS_SCHEDULED,
+    INTERFERENCE_EVENTS_ADDED,
+    INTERFERENCE_SNR_PER_CALCULATIONS,
+    INTERFERENCE_NI_CHANGES_MAX,
+    INTERFERENCE_ALLOCATIONS,
+    MAC_EVENTS_SCHEDULED,
+    MAC_ALLOCATIONS,
+    COUNTER_COUNT
+  };
+
+  static bool IsEnabled (void);
+  static void Increment (enum Counter counter);
+  /**
+   * Raise a high-water mark counter to value if it is lower.
+   */
+  static void Maximize (enum Counter counter, uint64_t value);
+  static uint64_t Get (enum Counter counter);
+  static const char * GetName (enum Counter counter);
+  static void Reset (void);
+  /**
+   * Print one "name value" line per counter.
+   */
+  static void Print (std::ostream &os);
+
+private:
+  static uint64_t m_counters[COUNTER_COUNT];
+};
+
+inline void
+CsmacaCounters::Increment (enum Counter counter)
+{
+  m_counters[counter]++;
+}
+
+inline void
+CsmacaCounters::Maximize (enum Counter counter, uint64_t value)
+{
+  if (m_counters[counter] < value)
+    {
+      m_counters[counter] = value;
+    }
+}
+
+} // namespace ns3
+
+#ifdef CSMACA_COUNTERS
+#define CSMACA_COUNT(counter) \
+  ns3::CsmacaCounters::Increment (ns3::CsmacaCounters::counter)
+#define CSMACA_COUNT_MAX(counter, value) \
+  ns3::CsmacaCounters::Maximize (ns3::CsmacaCounters::counter, value)
+#else
+#define CSMACA_COUNT(counter)
+#define CSMACA_COUNT_MAX(counter, value)
+#endif
+
+#endif /* CSMACA_COUNTERS_H */
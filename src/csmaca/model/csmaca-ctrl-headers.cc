@@ -0,0 +1,188 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "csmaca-ctrl-headers.h"
+#include "csmaca-block-ack-agreement.h"
+
+namespace ns3 {
+
+/***********************************
+ *     Block ack request
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaBlockAckReqHeader);
+
+CsmacaBlockAckReqHeader::CsmacaBlockAckReqHeader ()
+  : m_startingSeq (0)
+{
+}
+
+CsmacaBlockAckReqHeader::~CsmacaBlockAckReqHeader ()
+{
+}
+
+TypeId
+CsmacaBlockAckReqHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaBlockAckReqHeader")
+    .SetParent<Header> ()
+    .AddConstructor<CsmacaBlockAckReqHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CsmacaBlockAckReqHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CsmacaBlockAckReqHeader::Print (std::ostream &os) const
+{
+  os << "StartingSeq=" << m_startingSeq;
+}
+
+uint32_t
+CsmacaBlockAckReqHeader::GetSerializedSize (void) const
+{
+  return 2;
+}
+
+void
+CsmacaBlockAckReqHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteHtolsbU16 (m_startingSeq << 4);
+}
+
+uint32_t
+CsmacaBlockAckReqHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_startingSeq = (i.ReadLsbtohU16 () >> 4) & 0x0fff;
+  return i.GetDistanceFrom (start);
+}
+
+void
+CsmacaBlockAckReqHeader::SetStartingSequence (uint16_t seq)
+{
+  m_startingSeq = seq & 0x0fff;
+}
+
+uint16_t
+CsmacaBlockAckReqHeader::GetStartingSequence (void) const
+{
+  return m_startingSeq;
+}
+
+/***********************************
+ *       Block ack response
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaBlockAckHeader);
+
+CsmacaBlockAckHeader::CsmacaBlockAckHeader ()
+  : m_startingSeq (0),
+    m_bitmap (0)
+{
+}
+
+CsmacaBlockAckHeader::~CsmacaBlockAckHeader ()
+{
+}
+
+TypeId
+CsmacaBlockAckHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaBlockAckHeader")
+    .SetParent<Header> ()
+    .AddConstructor<CsmacaBlockAckHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CsmacaBlockAckHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CsmacaBlockAckHeader::Print (std::ostream &os) const
+{
+  os << "StartingSeq=" << m_startingSeq << ", Bitmap=" << std::hex << m_bitmap << std::dec;
+}
+
+uint32_t
+CsmacaBlockAckHeader::GetSerializedSize (void) const
+{
+  return 2 + 8;
+}
+
+void
+CsmacaBlockAckHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteHtolsbU16 (m_startingSeq << 4);
+  i.WriteHtolsbU64 (m_bitmap);
+}
+
+uint32_t
+CsmacaBlockAckHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  m_startingSeq = (i.ReadLsbtohU16 () >> 4) & 0x0fff;
+  m_bitmap = i.ReadLsbtohU64 ();
+  return i.GetDistanceFrom (start);
+}
+
+void
+CsmacaBlockAckHeader::SetStartingSequence (uint16_t seq)
+{
+  m_startingSeq = seq & 0x0fff;
+}
+
+uint16_t
+CsmacaBlockAckHeader::GetStartingSequence (void) const
+{
+  return m_startingSeq;
+}
+
+void
+CsmacaBlockAckHeader::SetReceivedPacket (uint16_t seq)
+{
+  uint16_t distance = CsmacaGetSequenceDistance (seq, m_startingSeq);
+  if (distance < CSMACA_BLOCK_ACK_WINDOW_SIZE)
+    {
+      m_bitmap |= ((uint64_t)1 << distance);
+    }
+}
+
+bool
+CsmacaBlockAckHeader::IsPacketReceived (uint16_t seq) const
+{
+  uint16_t distance = CsmacaGetSequenceDistance (seq, m_startingSeq);
+  if (distance < CSMACA_BLOCK_ACK_WINDOW_SIZE)
+    {
+      return (m_bitmap & ((uint64_t)1 << distance)) != 0;
+    }
+  return CsmacaIsOldSequence (seq, m_startingSeq);
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_CTRL_HEADERS_H
+#define CSMACA_CTRL_HEADERS_H
+
+#include <stdint.h>
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * Implements the body of the BlockAckReq frame
+ *
+ * |Starting Sequence Control|
+ *  Starting Sequence Control: 16 [bits]
+ */
+class CsmacaBlockAckReqHeader : public Header
+{
+public:
+  CsmacaBlockAckReqHeader ();
+  ~CsmacaBlockAckReqHeader ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  void SetStartingSequence (uint16_t seq);
+  uint16_t GetStartingSequence (void) const;
+
+private:
+  uint16_t m_startingSeq;
+};
+
+/**
+ * Implements the body of the BlockAck frame
+ *
+ * |Starting Sequence Control|Bitmap|
+ *  Starting Sequence Control: 16 [bits]
+ *  Bitmap:                    64 [bits] (bit i acknowledges starting sequence + i)
+ */
+class CsmacaBlockAckHeader : public Header
+{
+public:
+  CsmacaBlockAckHeader ();
+  ~CsmacaBlockAckHeader ();
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+  void SetStartingSequence (uint16_t seq);
+  uint16_t GetStartingSequence (void) const;
+  /**
+   * \param seq the sequence number of a received MPDU, inside the bitmap
+   */
+  void SetReceivedPacket (uint16_t seq);
+  /**
+   * A sequence number older than the starting sequence is reported as
+   * received: the recipient only moves its window past an MPDU once it
+   * has been received or given up by the originator.
+   *
+   * \param seq the sequence number of a transmitted MPDU
+   * \return true if the MPDU is acknowledged by this BlockAck
+   */
+  bool IsPacketReceived (uint16_t seq) const;
+
+private:
+  uint16_t m_startingSeq;
+  uint64_t m_bitmap;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_CTRL_HEADERS_H */
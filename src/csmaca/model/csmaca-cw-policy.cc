@@ -0,0 +1,323 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "csmaca-cw-policy.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaCwPolicy");
+
+namespace ns3 {
+
+static uint32_t
+ClampCw (double cw, uint32_t cwMin, uint32_t cwMax)
+{
+  if (cw <= cwMin)
+    {
+      return cwMin;
+    }
+  if (cw >= cwMax)
+    {
+      return cwMax;
+    }
+  return static_cast<uint32_t> (cw + 0.5);
+}
+
+/***********************************
+ *            Base
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaCwPolicy);
+
+TypeId
+CsmacaCwPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaCwPolicy")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+CsmacaCwPolicy::CsmacaCwPolicy ()
+{
+}
+
+CsmacaCwPolicy::~CsmacaCwPolicy ()
+{
+}
+
+uint32_t
+CsmacaCwPolicy::GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return cwMin;
+}
+
+void
+CsmacaCwPolicy::NotifyTransmission (uint32_t idleSlots)
+{
+}
+
+/***********************************
+ *            BEB
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaBebCwPolicy);
+
+TypeId
+CsmacaBebCwPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaBebCwPolicy")
+    .SetParent<CsmacaCwPolicy> ()
+    .AddConstructor<CsmacaBebCwPolicy> ()
+  ;
+  return tid;
+}
+
+uint32_t
+CsmacaBebCwPolicy::GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return cwMin;
+}
+
+uint32_t
+CsmacaBebCwPolicy::GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return std::min (2 * (cw + 1) - 1, cwMax);
+}
+
+/***********************************
+ *            EIED
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaEiedCwPolicy);
+
+TypeId
+CsmacaEiedCwPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaEiedCwPolicy")
+    .SetParent<CsmacaCwPolicy> ()
+    .AddConstructor<CsmacaEiedCwPolicy> ()
+    .AddAttribute ("IncreaseFactor", "Factor applied to CW + 1 after a failure.",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&CsmacaEiedCwPolicy::m_increaseFactor),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("DecreaseFactor", "Divisor applied to CW + 1 after a success.",
+                   DoubleValue (std::sqrt (2.0)),
+                   MakeDoubleAccessor (&CsmacaEiedCwPolicy::m_decreaseFactor),
+                   MakeDoubleChecker<double> (1.0))
+  ;
+  return tid;
+}
+
+CsmacaEiedCwPolicy::CsmacaEiedCwPolicy ()
+  : m_increaseFactor (2.0),
+    m_decreaseFactor (std::sqrt (2.0))
+{
+}
+
+uint32_t
+CsmacaEiedCwPolicy::GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return ClampCw ((cw + 1) / m_decreaseFactor - 1, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaEiedCwPolicy::GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return ClampCw ((cw + 1) * m_increaseFactor - 1, cwMin, cwMax);
+}
+
+/***********************************
+ *          Idle Sense
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaIdleSenseCwPolicy);
+
+TypeId
+CsmacaIdleSenseCwPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaIdleSenseCwPolicy")
+    .SetParent<CsmacaCwPolicy> ()
+    .AddConstructor<CsmacaIdleSenseCwPolicy> ()
+    .AddAttribute ("TargetIdleSlots", "Target mean number of idle slots between transmissions.",
+                   DoubleValue (5.68),
+                   MakeDoubleAccessor (&CsmacaIdleSenseCwPolicy::m_targetIdleSlots),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxTrans", "Number of transmissions over which idle slots are averaged.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&CsmacaIdleSenseCwPolicy::m_maxTrans),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Alpha", "Factor applied to CW when there are too few idle slots.",
+                   DoubleValue (1.0666),
+                   MakeDoubleAccessor (&CsmacaIdleSenseCwPolicy::m_alpha),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("Epsilon", "Decrease of CW when there are too many idle slots.",
+                   DoubleValue (6.0),
+                   MakeDoubleAccessor (&CsmacaIdleSenseCwPolicy::m_epsilon),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+CsmacaIdleSenseCwPolicy::CsmacaIdleSenseCwPolicy ()
+  : m_targetIdleSlots (5.68),
+    m_maxTrans (5),
+    m_alpha (1.0666),
+    m_epsilon (6.0),
+    m_cw (-1),
+    m_transmissions (0),
+    m_idleSlots (0)
+{
+}
+
+uint32_t
+CsmacaIdleSenseCwPolicy::GetCw (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  if (m_cw < 0)
+    {
+      m_cw = cw;
+    }
+  m_cw = std::max<double> (cwMin, std::min<double> (m_cw, cwMax));
+  return ClampCw (m_cw, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaIdleSenseCwPolicy::GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return GetCw (cw, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaIdleSenseCwPolicy::GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return GetCw (cw, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaIdleSenseCwPolicy::GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return GetCw (cw, cwMin, cwMax);
+}
+
+void
+CsmacaIdleSenseCwPolicy::NotifyTransmission (uint32_t idleSlots)
+{
+  m_idleSlots += idleSlots;
+  m_transmissions++;
+  if (m_transmissions < m_maxTrans || m_cw < 0)
+    {
+      return;
+    }
+  double meanIdleSlots = (double)m_idleSlots / m_transmissions;
+  if (meanIdleSlots < m_targetIdleSlots)
+    {
+      m_cw *= m_alpha;
+    }
+  else
+    {
+      m_cw -= m_epsilon;
+    }
+  CSMACA_LOG_DEBUG ("mean idle slots=" << meanIdleSlots << ", cw=" << m_cw);
+  m_idleSlots = 0;
+  m_transmissions = 0;
+}
+
+/***********************************
+ *    Target collision rate
+ ***********************************/
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaTargetCollisionRateCwPolicy);
+
+TypeId
+CsmacaTargetCollisionRateCwPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaTargetCollisionRateCwPolicy")
+    .SetParent<CsmacaCwPolicy> ()
+    .AddConstructor<CsmacaTargetCollisionRateCwPolicy> ()
+    .AddAttribute ("TargetCollisionRate", "Target failure rate of the own transmissions.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&CsmacaTargetCollisionRateCwPolicy::m_targetCollisionRate),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("Gain", "Relative change of CW after each outcome.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&CsmacaTargetCollisionRateCwPolicy::m_gain),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Weight", "Weight of the last outcome in the moving average of the failure rate.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&CsmacaTargetCollisionRateCwPolicy::m_weight),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+CsmacaTargetCollisionRateCwPolicy::CsmacaTargetCollisionRateCwPolicy ()
+  : m_targetCollisionRate (0.1),
+    m_gain (0.1),
+    m_weight (0.05),
+    m_collisionRate (0),
+    m_cw (-1)
+{
+}
+
+uint32_t
+CsmacaTargetCollisionRateCwPolicy::GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return Update (false, cw, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaTargetCollisionRateCwPolicy::GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  return Update (true, cw, cwMin, cwMax);
+}
+
+uint32_t
+CsmacaTargetCollisionRateCwPolicy::GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  // the failures leading to the drop are already counted
+  return cw;
+}
+
+uint32_t
+CsmacaTargetCollisionRateCwPolicy::Update (bool failed, uint32_t cw, uint32_t cwMin, uint32_t cwMax)
+{
+  if (m_cw < 0)
+    {
+      m_cw = cw;
+    }
+  m_collisionRate = (1 - m_weight) * m_collisionRate + m_weight * (failed ? 1.0 : 0.0);
+  if (m_collisionRate > m_targetCollisionRate)
+    {
+      m_cw *= 1 + m_gain;
+    }
+  else
+    {
+      m_cw /= 1 + m_gain;
+    }
+  m_cw = std::max<double> (cwMin, std::min<double> (m_cw, cwMax));
+  CSMACA_LOG_DEBUG ("collision rate=" << m_collisionRate << ", cw=" << m_cw);
+  return ClampCw (m_cw, cwMin, cwMax);
+}
+
+} // namespace ns3
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_CW_POLICY_H
+#define CSMACA_CW_POLICY_H
+
+#include <stdint.h>
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * Decides how the contention window of an access category evolves.
+ *
+ * Every access category owns its own policy object. The contention
+ * window is always returned within [cwMin, cwMax].
+ */
+class CsmacaCwPolicy : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaCwPolicy ();
+  virtual ~CsmacaCwPolicy ();
+
+  /**
+   * \param cw the current contention window
+   * \param cwMin the minimum contention window
+   * \param cwMax the maximum contention window
+   * \return the contention window after an acknowledged transmission
+   */
+  virtual uint32_t GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax) = 0;
+  /**
+   * \return the contention window after a missing CTS, ACK or BlockAck
+   */
+  virtual uint32_t GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax) = 0;
+  /**
+   * The default resets to cwMin, as IEEE 802.11 does.
+   *
+   * \return the contention window after a frame is discarded at the retry limit
+   */
+  virtual uint32_t GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  /**
+   * Called for every transmission heard on the medium, own ones included.
+   * The default does nothing.
+   *
+   * \param idleSlots the number of idle slots after DIFS which preceded it
+   */
+  virtual void NotifyTransmission (uint32_t idleSlots);
+};
+
+/**
+ * Binary exponential backoff of IEEE 802.11
+ */
+class CsmacaBebCwPolicy : public CsmacaCwPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  virtual uint32_t GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+};
+
+/**
+ * Exponential increase exponential decrease: (CW + 1) is multiplied
+ * by IncreaseFactor on failure and divided by DecreaseFactor on
+ * success. A DecreaseFactor of 2 gives the slow decrease scheme of
+ * halving instead of resetting.
+ */
+class CsmacaEiedCwPolicy : public CsmacaCwPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaEiedCwPolicy ();
+
+  virtual uint32_t GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+
+private:
+  double m_increaseFactor;
+  double m_decreaseFactor;
+};
+
+/**
+ * Idle Sense (Heusse et al., SIGCOMM 2005).
+ *
+ * Every MaxTrans transmissions heard on the medium, the mean number of
+ * idle slots between them is compared to TargetIdleSlots: below the
+ * target the window is multiplied by Alpha, above it the window is
+ * decreased by Epsilon. Failures do not change the window.
+ */
+class CsmacaIdleSenseCwPolicy : public CsmacaCwPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaIdleSenseCwPolicy ();
+
+  virtual uint32_t GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual void NotifyTransmission (uint32_t idleSlots);
+
+private:
+  uint32_t GetCw (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+
+  double m_targetIdleSlots;
+  uint32_t m_maxTrans;
+  double m_alpha;
+  double m_epsilon;
+
+  double m_cw;
+  uint32_t m_transmissions;
+  uint32_t m_idleSlots;
+};
+
+/**
+ * Keeps the failure rate of the own transmissions near a target.
+ *
+ * The failure rate is an exponentially weighted moving average over
+ * the outcome of every exchange. After each outcome the window is
+ * multiplied by (1 + Gain) if the rate is above TargetCollisionRate and
+ * divided by (1 + Gain) otherwise.
+ */
+class CsmacaTargetCollisionRateCwPolicy : public CsmacaCwPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaTargetCollisionRateCwPolicy ();
+
+  virtual uint32_t GetCwAfterSuccess (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterFailure (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+  virtual uint32_t GetCwAfterDrop (uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+
+private:
+  uint32_t Update (bool failed, uint32_t cw, uint32_t cwMin, uint32_t cwMax);
+
+  double m_targetCollisionRate;
+  double m_gain;
+  double m_weight;
+
+  double m_collisionRate;
+  double m_cw;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_CW_POLICY_H */
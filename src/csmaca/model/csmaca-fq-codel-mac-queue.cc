@@ -0,0 +1,466 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-fq-codel-mac-queue.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaFqCodelMacQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaFqCodelMacQueue);
+
+CsmacaFqCodelMacQueue::Flow::Flow ()
+  : deficit (0),
+    status (INACTIVE)
+{
+}
+
+TypeId
+CsmacaFqCodelMacQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaFqCodelMacQueue")
+    .SetParent<CsmacaMacQueue> ()
+    .AddConstructor<CsmacaFqCodelMacQueue> ()
+    .AddAttribute ("Flows", "Number of flow sub-queues.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&CsmacaFqCodelMacQueue::m_flowCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Quantum", "Bytes a flow may send in each round.",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&CsmacaFqCodelMacQueue::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Perturbation", "Seed of the flow hash.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaFqCodelMacQueue::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Target", "Target of the CoDel sub-queues.",
+                   TimeValue (MilliSeconds (5)),
+                   MakeTimeAccessor (&CsmacaFqCodelMacQueue::m_target),
+                   MakeTimeChecker ())
+    .AddAttribute ("Interval", "Interval of the CoDel sub-queues.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&CsmacaFqCodelMacQueue::m_interval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("CodelDrop", "A packet has been dropped by the CoDel of its flow",
+                     MakeTraceSourceAccessor (&CsmacaFqCodelMacQueue::m_codelDropTrace))
+  ;
+  return tid;
+}
+
+CsmacaFqCodelMacQueue::CsmacaFqCodelMacQueue ()
+  : m_flowCount (1024),
+    m_quantum (1500),
+    m_perturbation (0),
+    m_target (MilliSeconds (5)),
+    m_interval (MilliSeconds (100)),
+    m_totalSize (0),
+    m_totalBytes (0)
+{
+}
+
+CsmacaFqCodelMacQueue::~CsmacaFqCodelMacQueue ()
+{
+}
+
+void
+CsmacaFqCodelMacQueue::DoDispose (void)
+{
+  m_flows.clear ();
+  m_newFlows.clear ();
+  m_oldFlows.clear ();
+  m_totalSize = 0;
+  m_totalBytes = 0;
+  CsmacaMacQueue::DoDispose ();
+}
+
+uint32_t
+CsmacaFqCodelMacQueue::Classify (Ptr<const Packet> packet, const CsmacaMacHeader &hdr) const
+{
+  // LLC/SNAP (8 bytes), then up to a 60 byte IPv4 header and the ports
+  uint8_t buffer[72];
+  uint32_t size = packet->CopyData (buffer, std::min<uint32_t> (packet->GetSize (), sizeof (buffer)));
+  uint8_t key[43];
+  uint32_t keySize = 6;
+  hdr.GetAddr1 ().CopyTo (key);
+  if (size >= 8)
+    {
+      uint16_t protocol = (buffer[6] << 8) | buffer[7];
+      const uint8_t *ip = buffer + 8;
+      uint32_t addrOffset = 0;
+      uint32_t addrSize = 0;
+      uint32_t headerSize = 0;
+      uint8_t transport = 0;
+      if (protocol == 0x0800 && size >= 8 + 20 && (ip[0] >> 4) == 4)
+        {
+          addrOffset = 12;
+          addrSize = 8;
+          headerSize = (ip[0] & 0x0f) * 4;
+          transport = ip[9];
+        }
+      else if (protocol == 0x86dd && size >= 8 + 40)
+        {
+          addrOffset = 8;
+          addrSize = 32;
+          headerSize = 40;
+          transport = ip[6];
+        }
+      if (addrSize > 0)
+        {
+          std::copy (ip + addrOffset, ip + addrOffset + addrSize, key + keySize);
+          keySize += addrSize;
+          key[keySize++] = transport;
+          // TCP and UDP ports
+          if ((transport == 6 || transport == 17) && size >= 8 + headerSize + 4)
+            {
+              std::copy (ip + headerSize, ip + headerSize + 4, key + keySize);
+              keySize += 4;
+            }
+        }
+    }
+
+  // Jenkins one-at-a-time hash
+  uint32_t hash = m_perturbation;
+  for (uint32_t i = 0; i < keySize; i++)
+    {
+      hash += key[i];
+      hash += hash << 10;
+      hash ^= hash >> 6;
+    }
+  hash += hash << 3;
+  hash ^= hash >> 11;
+  hash += hash << 15;
+  return hash % m_flowCount;
+}
+
+void
+CsmacaFqCodelMacQueue::SetMaxDelay (Time delay)
+{
+  CsmacaMacQueue::SetMaxDelay (delay);
+  for (std::vector<Flow>::iterator it = m_flows.begin (); it != m_flows.end (); it++)
+    {
+      if (it->queue != 0)
+        {
+          it->queue->SetMaxDelay (delay);
+        }
+    }
+}
+
+CsmacaFqCodelMacQueue::Flow &
+CsmacaFqCodelMacQueue::GetFlow (uint32_t i)
+{
+  if (m_flows.empty ())
+    {
+      m_flows.resize (m_flowCount);
+    }
+  Flow &flow = m_flows[i];
+  if (flow.queue == 0)
+    {
+      // The limits apply to the sum of the sub-queues
+      flow.queue = CreateObject<CsmacaCodelMacQueue> ();
+      flow.queue->SetMaxSize (0xffffffff);
+      flow.queue->SetMaxBytes (0);
+      flow.queue->SetMaxDelay (m_maxDelay);
+      flow.queue->SetTarget (m_target);
+      flow.queue->SetInterval (m_interval);
+      flow.queue->TraceConnectWithoutContext ("CodelDrop",
+                                              MakeCallback (&CsmacaFqCodelMacQueue::NotifyCodelDrop, this));
+      flow.queue->TraceConnectWithoutContext ("Expired",
+                                              MakeCallback (&CsmacaFqCodelMacQueue::NotifyExpired, this));
+    }
+  return flow;
+}
+
+void
+CsmacaFqCodelMacQueue::NotifyCodelDrop (Ptr<const Packet> packet)
+{
+  NotifyRemoved (packet);
+  m_codelDropTrace (packet);
+}
+
+void
+CsmacaFqCodelMacQueue::NotifyExpired (Ptr<const Packet> packet)
+{
+  NotifyRemoved (packet);
+  m_expiredTrace (packet);
+}
+
+void
+CsmacaFqCodelMacQueue::NotifyRemoved (Ptr<const Packet> packet)
+{
+  m_totalSize--;
+  m_totalBytes -= packet->GetSize ();
+}
+
+uint32_t
+CsmacaFqCodelMacQueue::SelectFlow (void)
+{
+  while (true)
+    {
+      std::list<uint32_t> *flows;
+      if (!m_newFlows.empty ())
+        {
+          flows = &m_newFlows;
+        }
+      else if (!m_oldFlows.empty ())
+        {
+          flows = &m_oldFlows;
+        }
+      else
+        {
+          return m_flowCount;
+        }
+      uint32_t i = flows->front ();
+      Flow &flow = m_flows[i];
+      if (flow.deficit <= 0)
+        {
+          flow.deficit += m_quantum;
+          flow.status = OLD_FLOW;
+          flows->pop_front ();
+          m_oldFlows.push_back (i);
+          continue;
+        }
+      CsmacaMacHeader hdr;
+      if (flow.queue->Peek (&hdr) == 0)
+        {
+          flows->pop_front ();
+          // A new flow which empties goes through the old flows once so
+          // that it cannot starve them by becoming new again
+          if (flows == &m_newFlows && !m_oldFlows.empty ())
+            {
+              flow.status = OLD_FLOW;
+              m_oldFlows.push_back (i);
+            }
+          else
+            {
+              flow.status = INACTIVE;
+            }
+          continue;
+        }
+      return i;
+    }
+}
+
+uint32_t
+CsmacaFqCodelMacQueue::GetFattestFlow (void) const
+{
+  uint32_t fattest = m_flowCount;
+  uint32_t maxBytes = 0;
+  const std::list<uint32_t> *lists[2] = { &m_newFlows, &m_oldFlows };
+  for (uint32_t l = 0; l < 2; l++)
+    {
+      for (std::list<uint32_t>::const_iterator it = lists[l]->begin (); it != lists[l]->end (); it++)
+        {
+          uint32_t bytes = m_flows[*it].queue->GetNBytes ();
+          if (bytes > maxBytes)
+            {
+              maxBytes = bytes;
+              fattest = *it;
+            }
+        }
+    }
+  return fattest;
+}
+
+bool
+CsmacaFqCodelMacQueue::Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
+{
+  uint32_t i = Classify (packet, hdr);
+  Flow &flow = GetFlow (i);
+  uint32_t fattest = m_flowCount;
+  while (m_totalSize >= m_maxSize
+         || (m_maxBytes > 0 && m_totalBytes + packet->GetSize () > m_maxBytes))
+    {
+      if (fattest == m_flowCount)
+        {
+          fattest = GetFattestFlow ();
+        }
+      Ptr<const Packet> dropped;
+      if (fattest != m_flowCount && fattest != i)
+        {
+          // Retransmissions at the front of the flow are never dropped
+          dropped = m_flows[fattest].queue->DropNewest ();
+        }
+      if (dropped == 0)
+        {
+          m_dropTrace (packet);
+          return false;
+        }
+      NotifyRemoved (dropped);
+      m_dropTrace (dropped);
+    }
+  flow.queue->Enqueue (packet, hdr);
+  m_totalSize++;
+  m_totalBytes += packet->GetSize ();
+  if (flow.status == INACTIVE)
+    {
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      m_newFlows.push_back (i);
+    }
+  return true;
+}
+
+void
+CsmacaFqCodelMacQueue::PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
+{
+  uint32_t i = Classify (packet, hdr);
+  Flow &flow = GetFlow (i);
+  flow.queue->PushFront (packet, hdr);
+  m_totalSize++;
+  m_totalBytes += packet->GetSize ();
+  if (flow.status == INACTIVE)
+    {
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      m_newFlows.push_front (i);
+    }
+}
+
+Ptr<const Packet>
+CsmacaFqCodelMacQueue::Dequeue (CsmacaMacHeader *hdr)
+{
+  uint32_t i = SelectFlow ();
+  if (i == m_flowCount)
+    {
+      return 0;
+    }
+  Ptr<const Packet> packet = m_flows[i].queue->Dequeue (hdr);
+  if (packet != 0)
+    {
+      NotifyRemoved (packet);
+      m_flows[i].deficit -= packet->GetSize ();
+    }
+  return packet;
+}
+
+Ptr<const Packet>
+CsmacaFqCodelMacQueue::Peek (CsmacaMacHeader *hdr)
+{
+  uint32_t i = SelectFlow ();
+  if (i == m_flowCount)
+    {
+      return 0;
+    }
+  return m_flows[i].queue->Peek (hdr);
+}
+
+Ptr<const Packet>
+CsmacaFqCodelMacQueue::DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  std::list<uint32_t> *lists[2] = { &m_newFlows, &m_oldFlows };
+  for (uint32_t l = 0; l < 2; l++)
+    {
+      for (std::list<uint32_t>::iterator it = lists[l]->begin (); it != lists[l]->end (); it++)
+        {
+          Ptr<const Packet> packet = m_flows[*it].queue->DequeueByAddress (hdr, dest);
+          if (packet != 0)
+            {
+              NotifyRemoved (packet);
+              m_flows[*it].deficit -= packet->GetSize ();
+              return packet;
+            }
+        }
+    }
+  return 0;
+}
+
+Ptr<const Packet>
+CsmacaFqCodelMacQueue::PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  std::list<uint32_t> *lists[2] = { &m_newFlows, &m_oldFlows };
+  for (uint32_t l = 0; l < 2; l++)
+    {
+      for (std::list<uint32_t>::iterator it = lists[l]->begin (); it != lists[l]->end (); it++)
+        {
+          Ptr<const Packet> packet = m_flows[*it].queue->PeekByAddress (hdr, dest);
+          if (packet != 0)
+            {
+              return packet;
+            }
+        }
+    }
+  return 0;
+}
+
+bool
+CsmacaFqCodelMacQueue::Remove (Ptr<const Packet> packet)
+{
+  for (std::vector<Flow>::iterator it = m_flows.begin (); it != m_flows.end (); it++)
+    {
+      if (it->queue != 0 && it->queue->Remove (packet))
+        {
+          NotifyRemoved (packet);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+CsmacaFqCodelMacQueue::Flush (void)
+{
+  for (std::vector<Flow>::iterator it = m_flows.begin (); it != m_flows.end (); it++)
+    {
+      if (it->queue != 0)
+        {
+          it->queue->Flush ();
+        }
+      it->status = INACTIVE;
+    }
+  m_newFlows.clear ();
+  m_oldFlows.clear ();
+  m_totalSize = 0;
+  m_totalBytes = 0;
+}
+
+bool
+CsmacaFqCodelMacQueue::IsEmpty (void)
+{
+  std::list<uint32_t> *lists[2] = { &m_newFlows, &m_oldFlows };
+  for (uint32_t l = 0; l < 2; l++)
+    {
+      for (std::list<uint32_t>::iterator it = lists[l]->begin (); it != lists[l]->end (); it++)
+        {
+          if (!m_flows[*it].queue->IsEmpty ())
+            {
+              return false;
+            }
+        }
+    }
+  return true;
+}
+
+uint32_t
+CsmacaFqCodelMacQueue::GetSize (void)
+{
+  return m_totalSize;
+}
+
+uint32_t
+CsmacaFqCodelMacQueue::GetNBytes (void) const
+{
+  return m_totalBytes;
+}
+
+} // namespace ns3
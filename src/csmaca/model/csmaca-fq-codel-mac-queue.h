@@ -0,0 +1,128 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_FQ_CODEL_MAC_QUEUE_H
+#define CSMACA_FQ_CODEL_MAC_QUEUE_H
+
+#include <list>
+#include <vector>
+#include "csmaca-codel-mac-queue.h"
+
+namespace ns3 {
+
+/**
+ * Flow queueing with CoDel (RFC 8290).
+ *
+ * Frames are hashed on their receiver address and, for IPv4 and IPv6
+ * payloads, on their addresses, protocol and ports into one of Flows
+ * CoDel sub-queues. Sub-queues are served by deficit round robin with a
+ * quantum of Quantum bytes; a flow which becomes active is served before
+ * the flows which have already used their quantum.
+ *
+ * MaxPacketNumber and MaxBytes bound the sum of the sub-queues, which is
+ * kept up to date on every enqueue, dequeue and drop so that checking the
+ * limits does not visit the flows. When a frame would exceed the limits
+ * the newest frames of the longest flow which are not retransmissions
+ * are dropped, or the frame itself when its own flow is the longest one
+ * or the longest one only holds retransmissions.
+ *
+ * MaxDelay applies to every sub-queue, including those which already
+ * exist when it is set.
+ */
+class CsmacaFqCodelMacQueue : public CsmacaMacQueue
+{
+public:
+  static TypeId GetTypeId (void);
+  CsmacaFqCodelMacQueue ();
+  ~CsmacaFqCodelMacQueue ();
+
+  virtual void SetMaxDelay (Time delay);
+  virtual bool Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual void PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual Ptr<const Packet> Dequeue (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> Peek (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
+  virtual Ptr<const Packet> PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
+  virtual bool Remove (Ptr<const Packet> packet);
+  virtual void Flush (void);
+  virtual bool IsEmpty (void);
+  virtual uint32_t GetSize (void);
+  virtual uint32_t GetNBytes (void) const;
+
+private:
+  enum FlowStatus
+  {
+    INACTIVE,
+    NEW_FLOW,
+    OLD_FLOW
+  };
+  struct Flow
+  {
+    Flow ();
+    Ptr<CsmacaCodelMacQueue> queue;
+    int32_t deficit;
+    enum FlowStatus status;
+  };
+
+  virtual void DoDispose (void);
+
+  uint32_t Classify (Ptr<const Packet> packet, const CsmacaMacHeader &hdr) const;
+  /**
+   * \param i the index of a flow
+   * \return the flow, its sub-queue created if needed
+   */
+  Flow &GetFlow (uint32_t i);
+  /**
+   * Run the round robin up to the flow which sends next, without
+   * removing its frame.
+   *
+   * \return the index of the flow, or m_flowCount if all are empty
+   */
+  uint32_t SelectFlow (void);
+  /**
+   * \return the index of the active flow which holds the most bytes,
+   *         or m_flowCount if none
+   */
+  uint32_t GetFattestFlow (void) const;
+  void NotifyCodelDrop (Ptr<const Packet> packet);
+  void NotifyExpired (Ptr<const Packet> packet);
+  /**
+   * Account for a packet which left one of the sub-queues.
+   */
+  void NotifyRemoved (Ptr<const Packet> packet);
+
+  uint32_t m_flowCount;
+  uint32_t m_quantum;
+  uint32_t m_perturbation;
+  Time m_target;
+  Time m_interval;
+
+  std::vector<Flow> m_flows;
+  std::list<uint32_t> m_newFlows;
+  std::list<uint32_t> m_oldFlows;
+  uint32_t m_totalSize; //!< Packets in all the sub-queues
+  uint32_t m_totalBytes; //!< Bytes in all the sub-queues
+
+  TracedCallback<Ptr<const Packet> > m_codelDropTrace;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_FQ_CODEL_MAC_QUEUE_H */
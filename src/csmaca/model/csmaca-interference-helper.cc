@@ -38,10 +38,12 @@
  * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
  */
 #include "csmaca-interference-helper.h"
+#include "csmaca-counters.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include <algorithm>
 #include "ns3/math.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaInterferenceHelper");
 
@@ -144,7 +146,10 @@ CsmacaInterferenceHelper::Add (uint32_t size, Time duration, double rxPowerW, Cs
                                              duration,
                                              rxPowerW,
                                              preamble);
+  CSMACA_COUNT (INTERFERENCE_EVENTS_ADDED);
+  CSMACA_COUNT (INTERFERENCE_ALLOCATIONS);
   AppendEvent (event);
+  CSMACA_COUNT_MAX (INTERFERENCE_NI_CHANGES_MAX, m_niChanges.size ());
   return event;
 }
 
@@ -254,7 +259,7 @@ CsmacaInterferenceHelper::CheckChunkShannonCapacity (double snir, Time duration,
   shannonBits /= 8;
   shannonBits = shannonBits * duration.GetSeconds ();
   //  std::cout << "[Slimit]: " << shannonBits << ", [Bit]:" << nbits << ", [SNIR]:" << snir << " , [D]:" << duration << std::endl;
-  NS_LOG_DEBUG ("[Slimit]: " << shannonBits << ", [Bit]:" << nbits << ", [SNIR]:" << snir << " , [D]:" << duration);
+  CSMACA_LOG_DEBUG ("[Slimit]: " << shannonBits << ", [Bit]:" << nbits << ", [SNIR]:" << snir << " , [D]:" << duration);
     
   if (shannonBits >= nbits)
     {
@@ -267,7 +272,8 @@ CsmacaInterferenceHelper::CheckChunkShannonCapacity (double snir, Time duration,
 }
 
 double
-CsmacaInterferenceHelper::CalculatePer (Ptr<const CsmacaInterferenceHelper::Event> event, NiChanges *ni) const
+CsmacaInterferenceHelper::CalculatePer (Ptr<const CsmacaInterferenceHelper::Event> event, NiChanges *ni,
+                                        Time windowStart, Time windowEnd) const
 {
   CsmacaPreamble preambleHdr;
   double snr;
@@ -275,7 +281,6 @@ CsmacaInterferenceHelper::CalculatePer (Ptr<const CsmacaInterferenceHelper::Even
   NiChanges::iterator j = ni->begin ();
   Time previous = (*j).GetTime ();
 
-  Time preambleStart = (*j).GetTime ();
   Time payloadStart  = (*j).GetTime () + event->GetPreamble ().GetDuration ();
   double noiseInterferenceW = (*j).GetDelta ();
   double powerW = event->GetRxPowerW ();
@@ -285,37 +290,23 @@ CsmacaInterferenceHelper::CalculatePer (Ptr<const CsmacaInterferenceHelper::Even
   while (ni->end () != j)
     {
       Time current = (*j).GetTime ();
-      if (payloadStart > previous && payloadStart < current)
+      if (previous < payloadStart)
         {
-          
           // Header
+          Time headerEnd = Min (current, payloadStart);
           snr = CalculateSnr (powerW, noiseInterferenceW, preambleHdr);
-          if (!CheckChunkShannonCapacity (snr, payloadStart - previous, preambleHdr))
-            {
-              return 1;
-            }
-                                        
-          // Payload
-          snr = CalculateSnr (powerW, noiseInterferenceW, event->GetPreamble ());
-          if (!CheckChunkShannonCapacity (snr, current - payloadStart, event->GetPreamble ()))
+          if (!CheckChunkShannonCapacity (snr, headerEnd - previous, preambleHdr))
             {
               return 1;
             }
         }
-      else if (payloadStart >= current)
+      // Payload, limited to the window
+      Time chunkStart = Max (Max (previous, payloadStart), windowStart);
+      Time chunkEnd = Min (current, windowEnd);
+      if (chunkEnd > chunkStart)
         {
-          // Header
-          snr = CalculateSnr (powerW, noiseInterferenceW, preambleHdr);
-          if (!CheckChunkShannonCapacity (snr , current - previous, preambleHdr))
-            {
-              return 1;
-            }
-        }
-      else if (payloadStart < current)
-        {
-          // Payload
           snr = CalculateSnr (powerW, noiseInterferenceW, event->GetPreamble ());
-          if (!CheckChunkShannonCapacity (snr, current - previous, event->GetPreamble ()))
+          if (!CheckChunkShannonCapacity (snr, chunkEnd - chunkStart, event->GetPreamble ()))
             {
               return 1;
             }
@@ -332,6 +323,14 @@ CsmacaInterferenceHelper::CalculatePer (Ptr<const CsmacaInterferenceHelper::Even
 struct CsmacaInterferenceHelper::SnrPer
 CsmacaInterferenceHelper::CalculateSnrPer (Ptr<CsmacaInterferenceHelper::Event> event)
 {
+  return CalculateSnrPer (event, event->GetStartTime (), event->GetEndTime ());
+}
+
+struct CsmacaInterferenceHelper::SnrPer
+CsmacaInterferenceHelper::CalculateSnrPer (Ptr<CsmacaInterferenceHelper::Event> event,
+                                           Time windowStart, Time windowEnd)
+{
+  CSMACA_COUNT (INTERFERENCE_SNR_PER_CALCULATIONS);
   NiChanges ni;
   double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
   double snr = CalculateSnr (event->GetRxPowerW (),
@@ -341,7 +340,7 @@ CsmacaInterferenceHelper::CalculateSnrPer (Ptr<CsmacaInterferenceHelper::Event>
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePer (event, &ni);
+  double per = CalculatePer (event, &ni, windowStart, windowEnd);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -98,6 +98,18 @@ private:
   Ptr<CsmacaInterferenceHelper::Event> Add (uint32_t size, Time duration, double rxPower, CsmacaPreamble preamble);
 
   struct CsmacaInterferenceHelper::SnrPer CalculateSnrPer (Ptr<CsmacaInterferenceHelper::Event> event);
+  /**
+   * Calculate the SNR and the PER of the part of the payload which
+   * is received between windowStart and windowEnd. The preamble is
+   * always taken into account.
+   *
+   * \param event the event corresponding to the received frame
+   * \param windowStart the start of the payload part
+   * \param windowEnd the end of the payload part
+   * \return the SNR and the PER
+   */
+  struct CsmacaInterferenceHelper::SnrPer CalculateSnrPer (Ptr<CsmacaInterferenceHelper::Event> event,
+                                                           Time windowStart, Time windowEnd);
 
   void NotifyRxStart ();
   void NotifyRxEnd ();
@@ -128,7 +140,7 @@ private:
   double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
   double CalculateSnr (double signal, double noiseInterference, CsmacaPreamble preamble) const;
   bool CheckChunkShannonCapacity (double snir, Time duration, CsmacaPreamble preamble) const;
-  double CalculatePer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePer (Ptr<const Event> event, NiChanges *ni, Time windowStart, Time windowEnd) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   /// Experimental: needed for energy duration calculation
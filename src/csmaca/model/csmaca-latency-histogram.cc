@@ -0,0 +1,203 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "csmaca-latency-histogram.h"
+
+namespace ns3 {
+
+static uint32_t
+Log2Floor (uint64_t value)
+{
+  uint32_t log = 0;
+  for (uint32_t shift = 32; shift > 0; shift >>= 1)
+    {
+      if (value >= (static_cast<uint64_t> (1) << shift))
+        {
+          value >>= shift;
+          log += shift;
+        }
+    }
+  return log;
+}
+
+CsmacaLatencyHistogram::CsmacaLatencyHistogram (uint32_t precision)
+  : m_precision (precision)
+{
+  NS_ASSERT (precision >= 1 && precision <= 10);
+  // 2^precision linear buckets, then 2^precision per power of two up to 2^63
+  m_counts.resize ((64 - precision + 1) << precision);
+  Reset ();
+}
+
+void
+CsmacaLatencyHistogram::Reset (void)
+{
+  std::fill (m_counts.begin (), m_counts.end (), 0);
+  m_count = 0;
+  m_min = 0;
+  m_max = 0;
+  m_sum = 0;
+}
+
+uint32_t
+CsmacaLatencyHistogram::GetIndex (uint64_t value) const
+{
+  if (value < (static_cast<uint64_t> (1) << m_precision))
+    {
+      return static_cast<uint32_t> (value);
+    }
+  uint32_t log = Log2Floor (value);
+  uint32_t group = log - m_precision + 1;
+  uint32_t sub = static_cast<uint32_t> (value >> (log - m_precision)) & ((1 << m_precision) - 1);
+  return (group << m_precision) + sub;
+}
+
+uint64_t
+CsmacaLatencyHistogram::GetLowerBound (uint32_t index) const
+{
+  uint32_t group = index >> m_precision;
+  if (group == 0)
+    {
+      return index;
+    }
+  uint64_t sub = index & ((1 << m_precision) - 1);
+  return ((static_cast<uint64_t> (1) << m_precision) + sub) << (group - 1);
+}
+
+uint64_t
+CsmacaLatencyHistogram::GetUpperBound (uint32_t index) const
+{
+  uint32_t group = index >> m_precision;
+  if (group == 0)
+    {
+      return index;
+    }
+  return GetLowerBound (index) + (static_cast<uint64_t> (1) << (group - 1)) - 1;
+}
+
+void
+CsmacaLatencyHistogram::Add (Time value)
+{
+  int64_t ns = value.GetNanoSeconds ();
+  uint64_t v = ns > 0 ? static_cast<uint64_t> (ns) : 0;
+  m_counts[GetIndex (v)]++;
+  if (m_count == 0 || v < m_min)
+    {
+      m_min = v;
+    }
+  if (m_count == 0 || v > m_max)
+    {
+      m_max = v;
+    }
+  m_count++;
+  m_sum += v;
+}
+
+void
+CsmacaLatencyHistogram::Merge (const CsmacaLatencyHistogram &other)
+{
+  NS_ASSERT (other.m_precision == m_precision);
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+  if (m_count == 0 || other.m_min < m_min)
+    {
+      m_min = other.m_min;
+    }
+  if (m_count == 0 || other.m_max > m_max)
+    {
+      m_max = other.m_max;
+    }
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+uint64_t
+CsmacaLatencyHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+CsmacaLatencyHistogram::GetMin (void) const
+{
+  return NanoSeconds (m_min);
+}
+
+Time
+CsmacaLatencyHistogram::GetMax (void) const
+{
+  return NanoSeconds (m_max);
+}
+
+Time
+CsmacaLatencyHistogram::GetMean (void) const
+{
+  if (m_count == 0)
+    {
+      return NanoSeconds (0);
+    }
+  return NanoSeconds (static_cast<uint64_t> (m_sum / m_count + 0.5));
+}
+
+Time
+CsmacaLatencyHistogram::GetPercentile (double percent) const
+{
+  if (m_count == 0)
+    {
+      return NanoSeconds (0);
+    }
+  // Rank of the sample, counted from 1
+  uint64_t rank = static_cast<uint64_t> (percent / 100.0 * m_count + 0.5);
+  rank = std::max<uint64_t> (rank, 1);
+  rank = std::min (rank, m_count);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          uint64_t middle = GetLowerBound (i) + (GetUpperBound (i) - GetLowerBound (i)) / 2;
+          return NanoSeconds (std::min (std::max (middle, m_min), m_max));
+        }
+    }
+  return NanoSeconds (m_max);
+}
+
+void
+CsmacaLatencyHistogram::Print (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      if (m_counts[i] > 0)
+        {
+          os << GetLowerBound (i) << " " << GetUpperBound (i) << " " << m_counts[i] << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_LATENCY_HISTOGRAM_H
+#define CSMACA_LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+#include <ostream>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * Streaming histogram of non-negative durations with log-spaced
+ * buckets, in constant memory.
+ *
+ * Durations are counted in nanoseconds. Below 2^precision ns every
+ * nanosecond has its own bucket; above, every power of two is split into
+ * 2^precision buckets, so that a value is known to within a relative
+ * error of 2^-precision whatever its magnitude.
+ */
+class CsmacaLatencyHistogram
+{
+public:
+  /**
+   * \param precision the number of bits of the bucket index below the
+   *        power of two, from 1 to 10
+   */
+  explicit CsmacaLatencyHistogram (uint32_t precision = 4);
+
+  void Add (Time value);
+  /**
+   * Add the samples of another histogram of the same precision.
+   */
+  void Merge (const CsmacaLatencyHistogram &other);
+  void Reset (void);
+
+  uint64_t GetCount (void) const;
+  Time GetMin (void) const;
+  Time GetMax (void) const;
+  Time GetMean (void) const;
+  /**
+   * \param percent the percentile, from 0 to 100
+   * \return the middle of the bucket holding the percentile, clamped
+   *         to the smallest and largest samples
+   */
+  Time GetPercentile (double percent) const;
+  /**
+   * Print one "<lower ns> <upper ns> <count>" line per non-empty bucket.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  uint32_t GetIndex (uint64_t value) const;
+  uint64_t GetLowerBound (uint32_t index) const;
+  uint64_t GetUpperBound (uint32_t index) const;
+
+  uint32_t m_precision;
+  std::vector<uint64_t> m_counts;
+  uint64_t m_count;
+  uint64_t m_min;
+  uint64_t m_max;
+  double m_sum;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_LATENCY_HISTOGRAM_H */
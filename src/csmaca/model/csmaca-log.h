@@ -0,0 +1,44 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_LOG_H
+#define CSMACA_LOG_H
+
+#include "ns3/log.h"
+
+/**
+ * Logging macros of the csmaca module, which forward to NS_LOG_*.
+ *
+ * Configuring with --disable-csmaca-log defines CSMACA_NO_LOG, which
+ * removes every log statement of the module and the evaluation of its
+ * arguments at compile time, whatever the build profile. Information
+ * needed in such builds is available through the trace sources.
+ */
+#ifdef CSMACA_NO_LOG
+#define CSMACA_LOG_FUNCTION(parameters)
+#define CSMACA_LOG_DEBUG(msg)
+#define CSMACA_LOG_INFO(msg)
+#else
+#define CSMACA_LOG_FUNCTION(parameters) NS_LOG_FUNCTION (parameters)
+#define CSMACA_LOG_DEBUG(msg) NS_LOG_DEBUG (msg)
+#define CSMACA_LOG_INFO(msg) NS_LOG_INFO (msg)
+#endif
+
+#endif /* CSMACA_LOG_H */
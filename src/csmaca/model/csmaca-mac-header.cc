@@ -32,9 +32,18 @@ enum
   TYPE_ACK  = 1,
   TYPE_RTS  = 2,
   TYPE_CTS  = 3,
+  TYPE_BLOCK_ACK     = 4,
+  TYPE_BLOCK_ACK_REQ = 5
 };
 
 CsmacaMacHeader::CsmacaMacHeader ()
+  : m_ctrlType (TYPE_DATA),
+    m_ctrlRetry (0),
+    m_ctrlMoreFrag (0),
+    m_ctrlFourAddr (0),
+    m_duration (0),
+    m_seqSeq (0),
+    m_seqFrag (0)
 {
 }
 CsmacaMacHeader::~CsmacaMacHeader ()
@@ -51,6 +60,16 @@ CsmacaMacHeader::SetAddr2 (Mac48Address address)
 {
   m_addr2 = address;
 }
+void
+CsmacaMacHeader::SetAddr3 (Mac48Address address)
+{
+  m_addr3 = address;
+}
+void
+CsmacaMacHeader::SetAddr4 (Mac48Address address)
+{
+  m_addr4 = address;
+}
 
 void
 CsmacaMacHeader::SetType (enum CsmacaMacType type)
@@ -69,6 +88,12 @@ CsmacaMacHeader::SetType (enum CsmacaMacType type)
     case CSMACA_MAC_CTS:
       m_ctrlType = TYPE_CTS;
       break;
+    case CSMACA_MAC_BLOCK_ACK:
+      m_ctrlType = TYPE_BLOCK_ACK;
+      break;
+    case CSMACA_MAC_BLOCK_ACK_REQ:
+      m_ctrlType = TYPE_BLOCK_ACK_REQ;
+      break;
     }
 }
 
@@ -80,6 +105,47 @@ CsmacaMacHeader::SetDuration (Time duration)
   m_duration = static_cast<uint16_t> (duration_us);
 }
 
+void
+CsmacaMacHeader::SetSequenceNumber (uint16_t seq)
+{
+  m_seqSeq = seq & 0x0fff;
+}
+void
+CsmacaMacHeader::SetFragmentNumber (uint8_t frag)
+{
+  m_seqFrag = frag & 0x0f;
+}
+void
+CsmacaMacHeader::SetRetry (void)
+{
+  m_ctrlRetry = 1;
+}
+void
+CsmacaMacHeader::SetNoRetry (void)
+{
+  m_ctrlRetry = 0;
+}
+void
+CsmacaMacHeader::SetMoreFragments (void)
+{
+  m_ctrlMoreFrag = 1;
+}
+void
+CsmacaMacHeader::SetNoMoreFragments (void)
+{
+  m_ctrlMoreFrag = 0;
+}
+void
+CsmacaMacHeader::SetFourAddress (void)
+{
+  m_ctrlFourAddr = 1;
+}
+void
+CsmacaMacHeader::SetNoFourAddress (void)
+{
+  m_ctrlFourAddr = 0;
+}
+
 
 Mac48Address
 CsmacaMacHeader::GetAddr1 (void) const
@@ -91,6 +157,26 @@ CsmacaMacHeader::GetAddr2 (void) const
 {
   return m_addr2;
 }
+Mac48Address
+CsmacaMacHeader::GetAddr3 (void) const
+{
+  return m_addr3;
+}
+Mac48Address
+CsmacaMacHeader::GetAddr4 (void) const
+{
+  return m_addr4;
+}
+Mac48Address
+CsmacaMacHeader::GetDestination (void) const
+{
+  return IsFourAddress () ? m_addr3 : m_addr1;
+}
+Mac48Address
+CsmacaMacHeader::GetSource (void) const
+{
+  return IsFourAddress () ? m_addr4 : m_addr2;
+}
 
 
 enum CsmacaMacType
@@ -110,6 +196,12 @@ CsmacaMacHeader::GetType (void) const
     case TYPE_CTS:
       return CSMACA_MAC_CTS;
       break;
+    case TYPE_BLOCK_ACK:
+      return CSMACA_MAC_BLOCK_ACK;
+      break;
+    case TYPE_BLOCK_ACK_REQ:
+      return CSMACA_MAC_BLOCK_ACK_REQ;
+      break;
     }
   NS_ASSERT (false);
   return (enum CsmacaMacType)-1;
@@ -122,6 +214,37 @@ CsmacaMacHeader::GetDuration (void) const
   return MicroSeconds (m_duration);
 }
 
+uint16_t
+CsmacaMacHeader::GetSequenceControl (void) const
+{
+  return (m_seqSeq << 4) | m_seqFrag;
+}
+uint16_t
+CsmacaMacHeader::GetSequenceNumber (void) const
+{
+  return m_seqSeq;
+}
+uint8_t
+CsmacaMacHeader::GetFragmentNumber (void) const
+{
+  return m_seqFrag;
+}
+bool
+CsmacaMacHeader::IsRetry (void) const
+{
+  return (m_ctrlRetry == 1);
+}
+bool
+CsmacaMacHeader::IsMoreFragments (void) const
+{
+  return (m_ctrlMoreFrag == 1);
+}
+bool
+CsmacaMacHeader::IsFourAddress (void) const
+{
+  return (m_ctrlType == TYPE_DATA && m_ctrlFourAddr == 1);
+}
+
 uint32_t
 CsmacaMacHeader::GetSize (void) const
 {
@@ -129,7 +252,11 @@ CsmacaMacHeader::GetSize (void) const
   switch (m_ctrlType)
     {
     case TYPE_DATA:
-      size = 2 + 2 + 6 + 6;
+      size = 2 + 2 + 6 + 6 + 2;
+      if (IsFourAddress ())
+        {
+          size += 6 + 6;
+        }
       break;
     case TYPE_ACK:
       size = 2 + 2 + 6;
@@ -140,6 +267,10 @@ CsmacaMacHeader::GetSize (void) const
     case TYPE_CTS:
       size = 2 + 2 + 6;
       break;
+    case TYPE_BLOCK_ACK:
+    case TYPE_BLOCK_ACK_REQ:
+      size = 2 + 2 + 6 + 6;
+      break;
     }
   return size;
 }
@@ -168,7 +299,13 @@ CsmacaMacHeader::Print (std::ostream &os) const
   switch (GetType ())
     {
     case TYPE_DATA:
-      os << ", DA=" << m_addr1 << ", SA=" << m_addr2;
+      os << ", DA=" << m_addr1 << ", SA=" << m_addr2
+         << ", SeqNumber=" << m_seqSeq << ", FragNumber=" << (uint32_t)m_seqFrag
+         << ", Retry=" << (uint32_t)m_ctrlRetry << ", MoreFrag=" << (uint32_t)m_ctrlMoreFrag;
+      if (IsFourAddress ())
+        {
+          os << ", Addr3=" << m_addr3 << ", Addr4=" << m_addr4;
+        }
       break;
     case TYPE_ACK:
       os << "DA=" << m_addr1;
@@ -179,19 +316,35 @@ CsmacaMacHeader::Print (std::ostream &os) const
     case TYPE_CTS:
       os << "DA=" << m_addr1;
       break;
+    case TYPE_BLOCK_ACK:
+    case TYPE_BLOCK_ACK_REQ:
+      os << ", DA=" << m_addr1 << ", SA=" << m_addr2;
+      break;
     }
 }
 uint16_t
 CsmacaMacHeader::GetFrameControl (void) const
 {
   uint16_t val = 0;
-  val |= m_ctrlType & 0x3;
+  val |= m_ctrlType & 0x7;
+  val |= (m_ctrlRetry << 3) & (1 << 3);
+  val |= (m_ctrlMoreFrag << 4) & (1 << 4);
+  val |= (m_ctrlFourAddr << 5) & (1 << 5);
   return val;
 }
 void
 CsmacaMacHeader::SetFrameControl (uint16_t ctrl)
 {
-  m_ctrlType = ctrl & 0x03;
+  m_ctrlType = ctrl & 0x07;
+  m_ctrlRetry = (ctrl >> 3) & 0x01;
+  m_ctrlMoreFrag = (ctrl >> 4) & 0x01;
+  m_ctrlFourAddr = (ctrl >> 5) & 0x01;
+}
+void
+CsmacaMacHeader::SetSequenceControl (uint16_t seq)
+{
+  m_seqFrag = seq & 0x0f;
+  m_seqSeq = (seq >> 4) & 0x0fff;
 }
 uint32_t
 CsmacaMacHeader::GetSerializedSize (void) const
@@ -208,6 +361,12 @@ CsmacaMacHeader::Serialize (Buffer::Iterator i) const
     {
     case TYPE_DATA:
       WriteTo (i, m_addr2);
+      i.WriteHtolsbU16 (GetSequenceControl ());
+      if (IsFourAddress ())
+        {
+          WriteTo (i, m_addr3);
+          WriteTo (i, m_addr4);
+        }
       break;
     case TYPE_ACK:
       // do nothing
@@ -218,6 +377,10 @@ CsmacaMacHeader::Serialize (Buffer::Iterator i) const
     case TYPE_CTS:
       // do nothing
       break;
+    case TYPE_BLOCK_ACK:
+    case TYPE_BLOCK_ACK_REQ:
+      WriteTo (i, m_addr2);
+      break;
     }
 }
 
@@ -233,6 +396,12 @@ CsmacaMacHeader::Deserialize (Buffer::Iterator start)
     {
     case TYPE_DATA:
       ReadFrom (i, m_addr2);
+      SetSequenceControl (i.ReadLsbtohU16 ());
+      if (IsFourAddress ())
+        {
+          ReadFrom (i, m_addr3);
+          ReadFrom (i, m_addr4);
+        }
       break;
     case TYPE_ACK:
       // do nothing
@@ -243,6 +412,10 @@ CsmacaMacHeader::Deserialize (Buffer::Iterator start)
     case TYPE_CTS:
       // do nothing
       break;
+    case TYPE_BLOCK_ACK:
+    case TYPE_BLOCK_ACK_REQ:
+      ReadFrom (i, m_addr2);
+      break;
     }
   return i.GetDistanceFrom (start);
 }
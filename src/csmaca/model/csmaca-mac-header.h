@@ -38,13 +38,20 @@ enum CsmacaMacType
   CSMACA_MAC_DATA = 0,
   CSMACA_MAC_ACK,
   CSMACA_MAC_RTS,
-  CSMACA_MAC_CTS
+  CSMACA_MAC_CTS,
+  CSMACA_MAC_BLOCK_ACK,
+  CSMACA_MAC_BLOCK_ACK_REQ
 };
 
 /**
  * \ingroup wifi
  *
  * Implements the IEEE 802.11 MAC header
+ *
+ * A data frame relayed on behalf of another station carries two more
+ * addresses after the sequence control, as a WDS frame does: Addr1 is
+ * the receiver, Addr2 the transmitter, Addr3 the final destination and
+ * Addr4 the original source.
  */
 class CsmacaMacHeader : public Header
 {
@@ -56,7 +63,9 @@ public:
   enum AddressType
   {
     ADDR1,
-    ADDR2
+    ADDR2,
+    ADDR3,
+    ADDR4
   };
 
   CsmacaMacHeader ();
@@ -72,13 +81,42 @@ public:
   void SetTypeData (void);
   void SetAddr1 (Mac48Address address);
   void SetAddr2 (Mac48Address address);
+  void SetAddr3 (Mac48Address address);
+  void SetAddr4 (Mac48Address address);
   void SetType (enum CsmacaMacType type);
   void SetDuration (Time duration);
+  void SetSequenceNumber (uint16_t seq);
+  void SetFragmentNumber (uint8_t frag);
+  void SetRetry (void);
+  void SetNoRetry (void);
+  void SetMoreFragments (void);
+  void SetNoMoreFragments (void);
+  /**
+   * Carry Addr3 and Addr4 in a data frame
+   */
+  void SetFourAddress (void);
+  void SetNoFourAddress (void);
 
   Mac48Address GetAddr1 (void) const;
   Mac48Address GetAddr2 (void) const;
+  Mac48Address GetAddr3 (void) const;
+  Mac48Address GetAddr4 (void) const;
+  /**
+   * \return the final destination: Addr3 in a four address frame, Addr1 otherwise
+   */
+  Mac48Address GetDestination (void) const;
+  /**
+   * \return the original source: Addr4 in a four address frame, Addr2 otherwise
+   */
+  Mac48Address GetSource (void) const;
   enum CsmacaMacType GetType (void) const;
   Time GetDuration (void) const;
+  uint16_t GetSequenceControl (void) const;
+  uint16_t GetSequenceNumber (void) const;
+  uint8_t GetFragmentNumber (void) const;
+  bool IsRetry (void) const;
+  bool IsMoreFragments (void) const;
+  bool IsFourAddress (void) const;
   uint16_t GetFrameControl (void) const;
   uint32_t GetSize (void) const;
   const char * GetTypeString (void) const;
@@ -89,10 +127,16 @@ private:
   void PrintFrameControl (std::ostream &os) const;
 
   uint8_t m_ctrlType;
+  uint8_t m_ctrlRetry;
+  uint8_t m_ctrlMoreFrag;
+  uint8_t m_ctrlFourAddr;
   uint16_t m_duration;
   Mac48Address m_addr1;
   Mac48Address m_addr2;
+  Mac48Address m_addr3;
+  Mac48Address m_addr4;
   uint16_t m_seqSeq;
+  uint8_t m_seqFrag;
 };
 
 } // namespace ns3
@@ -43,6 +43,7 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
 
 #include "csmaca-mac-queue.h"
 
@@ -50,14 +51,7 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (CsmacaMacQueue);
 
-CsmacaMacQueue::Item::Item (Ptr<const Packet> packet,
-                          const CsmacaMacHeader &hdr,
-                          Time tstamp)
-  : packet (packet),
-    hdr (hdr),
-    tstamp (tstamp)
-{
-}
+static const uint32_t CSMACA_MAC_QUEUE_INITIAL_SLOTS = 16;
 
 TypeId
 CsmacaMacQueue::GetTypeId (void)
@@ -69,12 +63,32 @@ CsmacaMacQueue::GetTypeId (void)
                    UintegerValue (400),
                    MakeUintegerAccessor (&CsmacaMacQueue::m_maxSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxBytes", "If a packet arrives when it would make the queue exceed this number of bytes, "
+                   "it is dropped. 0 disables the limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaMacQueue::m_maxBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxDelay", "If a packet stays longer than this delay in the queue, it is dropped.",
+                   TimeValue (Seconds (10.0)),
+                   MakeTimeAccessor (&CsmacaMacQueue::SetMaxDelay,
+                                     &CsmacaMacQueue::GetMaxDelay),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Drop", "A packet has been dropped because the queue is full",
+                     MakeTraceSourceAccessor (&CsmacaMacQueue::m_dropTrace))
+    .AddTraceSource ("Expired", "A packet has been dropped because it stayed longer than MaxDelay",
+                     MakeTraceSourceAccessor (&CsmacaMacQueue::m_expiredTrace))
   ;
   return tid;
 }
 
 CsmacaMacQueue::CsmacaMacQueue ()
-  : m_size (0)
+  : m_ring (CSMACA_MAC_QUEUE_INITIAL_SLOTS),
+    m_head (0),
+    m_size (0),
+    m_maxSize (400),
+    m_bytes (0),
+    m_maxBytes (0),
+    m_maxDelay (Seconds (10.0))
 {
 }
 
@@ -97,51 +111,206 @@ CsmacaMacQueue::GetMaxSize (void) const
 }
 
 void
+CsmacaMacQueue::SetMaxBytes (uint32_t maxBytes)
+{
+  m_maxBytes = maxBytes;
+}
+
+uint32_t
+CsmacaMacQueue::GetMaxBytes (void) const
+{
+  return m_maxBytes;
+}
+
+void
+CsmacaMacQueue::SetMaxDelay (Time delay)
+{
+  m_maxDelay = delay;
+}
+
+Time
+CsmacaMacQueue::GetMaxDelay (void) const
+{
+  return m_maxDelay;
+}
+
+CsmacaMacQueue::Item &
+CsmacaMacQueue::At (uint32_t i)
+{
+  return m_ring[(m_head + i) & (m_ring.size () - 1)];
+}
+
+void
+CsmacaMacQueue::Grow (void)
+{
+  std::vector<Item> ring (2 * m_ring.size ());
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      Item &item = At (i);
+      ring[i].packet = item.packet;
+      ring[i].hdr = item.hdr;
+      ring[i].tstamp = item.tstamp;
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+}
+
+void
+CsmacaMacQueue::Erase (uint32_t i)
+{
+  m_bytes -= At (i).packet->GetSize ();
+  for (; i > 0; i--)
+    {
+      Item &item = At (i);
+      Item &prev = At (i - 1);
+      item.packet = prev.packet;
+      item.hdr = prev.hdr;
+      item.tstamp = prev.tstamp;
+    }
+  At (0).packet = 0;
+  m_head = (m_head + 1) & (m_ring.size () - 1);
+  m_size--;
+}
+
+void
+CsmacaMacQueue::PopFront (void)
+{
+  Item &item = At (0);
+  m_bytes -= item.packet->GetSize ();
+  item.packet = 0;
+  m_head = (m_head + 1) & (m_ring.size () - 1);
+  m_size--;
+}
+
+void
+CsmacaMacQueue::Cleanup (void)
+{
+  Time now = Simulator::Now ();
+  // Retransmissions already hold a sequence number which the recipient
+  // waits for, so they are left to the retry limit of the MAC
+  while (m_size > 0 && !At (0).hdr.IsRetry () && At (0).tstamp + m_maxDelay <= now)
+    {
+      m_expiredTrace (At (0).packet);
+      PopFront ();
+    }
+}
+
+uint32_t
+CsmacaMacQueue::Find (Mac48Address dest)
+{
+  uint32_t i = 0;
+  while (i < m_size && At (i).hdr.GetAddr1 () != dest)
+    {
+      i++;
+    }
+  return i;
+}
+
+bool
 CsmacaMacQueue::Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
 {
   Cleanup ();
-  if (m_size == m_maxSize)
+  if (m_size >= m_maxSize
+      || (m_maxBytes > 0 && m_bytes + packet->GetSize () > m_maxBytes))
     {
-      return;
+      m_dropTrace (packet);
+      return false;
     }
-  Time now = Simulator::Now ();
-  m_queue.push_back (Item (packet, hdr, now));
+  if (m_size == m_ring.size ())
+    {
+      Grow ();
+    }
+  Item &item = At (m_size);
+  item.packet = packet;
+  item.hdr = hdr;
+  item.tstamp = Simulator::Now ();
+  m_size++;
+  m_bytes += packet->GetSize ();
+  return true;
+}
+
+void
+CsmacaMacQueue::PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr)
+{
+  if (m_size == m_ring.size ())
+    {
+      Grow ();
+    }
+  // The frame inherits the timestamp of the front so that timestamps
+  // stay ordered for Cleanup
+  Time tstamp = m_size > 0 ? At (0).tstamp : Simulator::Now ();
+  m_head = (m_head - 1) & (m_ring.size () - 1);
+  Item &item = At (0);
+  item.packet = packet;
+  item.hdr = hdr;
+  item.tstamp = tstamp;
   m_size++;
+  m_bytes += packet->GetSize ();
 }
 
 Ptr<const Packet>
 CsmacaMacQueue::Dequeue (CsmacaMacHeader *hdr)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  if (m_size == 0)
     {
-      Item i = m_queue.front ();
-      m_queue.pop_front ();
-      m_size--;
-      *hdr = i.hdr;
-      return i.packet;
+      return 0;
     }
-  return 0;
+  Item &item = At (0);
+  *hdr = item.hdr;
+  Ptr<const Packet> packet = item.packet;
+  PopFront ();
+  return packet;
 }
 
 Ptr<const Packet>
 CsmacaMacQueue::Peek (CsmacaMacHeader *hdr)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  if (m_size == 0)
+    {
+      return 0;
+    }
+  Item &item = At (0);
+  *hdr = item.hdr;
+  return item.packet;
+}
+
+Ptr<const Packet>
+CsmacaMacQueue::DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  Cleanup ();
+  uint32_t i = Find (dest);
+  if (i == m_size)
     {
-      Item i = m_queue.front ();
-      *hdr = i.hdr;
-      return i.packet;
+      return 0;
     }
-  return 0;
+  Item &item = At (i);
+  *hdr = item.hdr;
+  Ptr<const Packet> packet = item.packet;
+  Erase (i);
+  return packet;
+}
+
+Ptr<const Packet>
+CsmacaMacQueue::PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest)
+{
+  Cleanup ();
+  uint32_t i = Find (dest);
+  if (i == m_size)
+    {
+      return 0;
+    }
+  Item &item = At (i);
+  *hdr = item.hdr;
+  return item.packet;
 }
 
 bool
 CsmacaMacQueue::IsEmpty (void)
 {
   Cleanup ();
-  return m_queue.empty ();
+  return m_size == 0;
 }
 
 uint32_t
@@ -150,23 +319,41 @@ CsmacaMacQueue::GetSize (void)
   return m_size;
 }
 
+uint32_t
+CsmacaMacQueue::GetNBytes (void) const
+{
+  return m_bytes;
+}
+
+void
+CsmacaMacQueue::NotifyAirtime (Mac48Address dest, Time airtime)
+{
+}
+
+bool
+CsmacaMacQueue::IsScheduledPerDestination (void) const
+{
+  return false;
+}
+
 void
 CsmacaMacQueue::Flush (void)
 {
-  m_queue.erase (m_queue.begin (), m_queue.end ());
-  m_size = 0;
+  while (m_size > 0)
+    {
+      PopFront ();
+    }
+  m_head = 0;
 }
 
 bool
 CsmacaMacQueue::Remove (Ptr<const Packet> packet)
 {
-  PacketQueueI it = m_queue.begin ();
-  for (; it != m_queue.end (); it++)
+  for (uint32_t i = 0; i < m_size; i++)
     {
-      if (it->packet == packet)
+      if (At (i).packet == packet)
         {
-          m_queue.erase (it);
-          m_size--;
+          Erase (i);
           return true;
         }
     }
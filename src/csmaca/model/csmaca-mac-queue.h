@@ -43,15 +43,28 @@
 #ifndef CSMACA_MAC_QUEUE_H
 #define CSMACA_MAC_QUEUE_H
 
-#include <list>
-#include <utility>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
+#include "ns3/traced-callback.h"
 #include "csmaca-mac-header.h"
 
 namespace ns3 {
 
+/**
+ * A FIFO of frames waiting for the medium, stored in a ring buffer.
+ *
+ * Enqueue, PushFront, Dequeue and Peek take constant time; the ring
+ * doubles when full, so that its slots are reused once the queue has
+ * reached its working size. A frame is dropped at Enqueue when the
+ * queue already holds MaxPacketNumber frames or when it would exceed
+ * MaxBytes. Frames which have waited longer than MaxDelay are dropped
+ * from the front of the queue before any access.
+ *
+ * Active queue management is provided by subclasses, which an access
+ * category selects through its QueueType attribute.
+ */
 class CsmacaMacQueue : public Object
 {
 public:
@@ -71,35 +84,65 @@ public:
    * \return the maximum queue size
    */
   uint32_t GetMaxSize (void) const;
+  /**
+   * \param maxBytes the maximum number of bytes in the queue, 0 for no limit
+   */
+  void SetMaxBytes (uint32_t maxBytes);
+  uint32_t GetMaxBytes (void) const;
+  /**
+   * \param delay the time after which a queued packet is dropped
+   */
+  virtual void SetMaxDelay (Time delay);
+  Time GetMaxDelay (void) const;
 
   /**
    * Enqueue the given packet and its corresponding CsmacaMacHeader at the <i>end</i> of the queue.
    *
    * \param packet the packet to be euqueued at the end
    * \param hdr the header of the given packet
+   * \return false if the packet was dropped because the queue is full
    */
-  void Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual bool Enqueue (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
   /**
    * Enqueue the given packet and its corresponding CsmacaMacHeader at the <i>front</i> of the queue.
+   * The limits are not checked: the frame was already accepted once.
    *
    * \param packet the packet to be euqueued at the end
    * \param hdr the header of the given packet
    */
-  void PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
+  virtual void PushFront (Ptr<const Packet> packet, const CsmacaMacHeader &hdr);
   /**
    * Dequeue the packet in the front of the queue.
    *
    * \param hdr the CsmacaMacHeader of the packet
    * \return the packet
    */
-  Ptr<const Packet> Dequeue (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> Dequeue (CsmacaMacHeader *hdr);
   /**
    * Peek the packet in the front of the queue. The packet is not removed.
    *
    * \param hdr the CsmacaMacHeader of the packet
    * \return the packet
    */
-  Ptr<const Packet> Peek (CsmacaMacHeader *hdr);
+  virtual Ptr<const Packet> Peek (CsmacaMacHeader *hdr);
+  /**
+   * Dequeue the first packet in the queue which is addressed to the given
+   * destination.
+   *
+   * \param hdr the CsmacaMacHeader of the packet
+   * \param dest the destination address of the packet
+   * \return the packet, or 0 if there is no such packet
+   */
+  virtual Ptr<const Packet> DequeueByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
+  /**
+   * Peek the first packet in the queue which is addressed to the given
+   * destination. The packet is not removed.
+   *
+   * \param hdr the CsmacaMacHeader of the packet
+   * \param dest the destination address of the packet
+   * \return the packet, or 0 if there is no such packet
+   */
+  virtual Ptr<const Packet> PeekByAddress (CsmacaMacHeader *hdr, Mac48Address dest);
 
   /**
    * If exists, removes <i>packet</i> from queue and returns true. Otherwise it
@@ -109,66 +152,97 @@ public:
    * \param packet the packet to be removed
    * \return true if the packet was removed, false otherwise
    */
-  bool Remove (Ptr<const Packet> packet);
+  virtual bool Remove (Ptr<const Packet> packet);
 
   /**
    * Flush the queue.
    */
-  void Flush (void);
+  virtual void Flush (void);
 
   /**
    * Return if the queue is empty.
    *
    * \return true if the queue is empty, false otherwise
    */
-  bool IsEmpty (void);
+  virtual bool IsEmpty (void);
   /**
    * Return the current queue size.
    *
    * \return the current queue size
    */
-  uint32_t GetSize (void);
-protected:
-
-  struct Item;
-
+  virtual uint32_t GetSize (void);
   /**
-   * typedef for packet (struct Item) queue.
+   * \return the number of bytes of the packets in the queue
    */
-  typedef std::list<struct Item> PacketQueue;
+  virtual uint32_t GetNBytes (void) const;
   /**
-   * typedef for packet (struct Item) queue reverse iterator.
+   * Charge the medium time used by an exchange with the given
+   * destination. The default does nothing.
+   *
+   * \param dest the destination of the exchange
+   * \param airtime the time the medium was used
    */
-  typedef std::list<struct Item>::reverse_iterator PacketQueueRI;
+  virtual void NotifyAirtime (Mac48Address dest, Time airtime);
   /**
-   * typedef for packet (struct Item) queue iterator.
+   * \return true if Peek and Dequeue choose the destination served next,
+   *         in which case the MAC also lets frames to other destinations
+   *         overtake a frame waiting for its retransmission
    */
-  typedef std::list<struct Item>::iterator PacketQueueI;
-
+  virtual bool IsScheduledPerDestination (void) const;
+protected:
   /**
    * A struct that holds information about a packet for putting
    * in a packet queue.
    */
   struct Item
   {
-    /**
-     * Create a struct with the given parameters.
-     *
-     * \param packet
-     * \param hdr
-     * \param tstamp
-     */
-    Item (Ptr<const Packet> packet,
-          const CsmacaMacHeader &hdr,
-          Time tstamp);
     Ptr<const Packet> packet; //!< Actual packet
     CsmacaMacHeader hdr; //!< Csmaca MAC header associated with the packet
     Time tstamp; //!< timestamp when the packet arrived at the queue
   };
 
-  PacketQueue m_queue; //!< Packet (struct Item) queue
+  /**
+   * \param i the position in the queue, 0 being the front
+   * \return the slot of the ring which holds it
+   */
+  Item &At (uint32_t i);
+  /**
+   * Double the ring, keeping the order of the items.
+   */
+  void Grow (void);
+  /**
+   * Remove the item at the given position, moving the items in front
+   * of it by one slot.
+   *
+   * \param i the position in the queue, 0 being the front
+   */
+  void Erase (uint32_t i);
+  /**
+   * Release the packet of the front item and advance the front.
+   */
+  void PopFront (void);
+  /**
+   * Drop the expired packets at the front of the queue. Timestamps never
+   * decrease from the front to the back, so only the expired packets
+   * are visited.
+   */
+  void Cleanup (void);
+  /**
+   * \param dest the destination address
+   * \return the position of the first frame to dest, or m_size if none
+   */
+  uint32_t Find (Mac48Address dest);
+
+  std::vector<Item> m_ring; //!< Slots, the size is a power of two
+  uint32_t m_head; //!< Slot of the front item
   uint32_t m_size; //!< Current queue size
   uint32_t m_maxSize; //!< Queue capacity
+  uint32_t m_bytes; //!< Bytes in the queue
+  uint32_t m_maxBytes; //!< Byte capacity, 0 for no limit
+  Time m_maxDelay; //!< Time to live of a queued packet
+
+  TracedCallback<Ptr<const Packet> > m_dropTrace;
+  TracedCallback<Ptr<const Packet> > m_expiredTrace;
 };
 
 } // namespace ns3
@@ -25,6 +25,8 @@
 #include "csmaca-mac-header.h"
 #include "csmaca-mac-trailer.h"
 #include "csmaca-mac.h"
+#include "csmaca-counters.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaMac");
 
@@ -67,25 +69,39 @@ public:
   {
     m_csmacaMac->ReceiveError (packet);
   }
+  virtual void NotifyRxEndAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus,
+                                 std::vector<bool> statusPerMpdu)
+  {
+    m_csmacaMac->ReceiveAmpdu (mpdus, statusPerMpdu);
+  }
 private:
   ns3::CsmacaMac *m_csmacaMac;
 };
 
 CsmacaMac::CsmacaMac ()
   : m_phyCsmacaMacListener (0),
+    m_currentAc (CSMACA_AC_BE),
+    m_maxAmpduSize (0),
+    m_currentAmpdu (false),
+    m_txopLimit (Seconds (0)),
+    m_txopStart (Seconds (0)),
+    m_fragmentationThreshold (0),
+    m_fragmentNumber (0),
+    m_saturation (false),
+    m_saturationPacketSize (1000),
+    m_saturationDestination (Mac48Address::GetBroadcast ()),
+    m_saturationAc (CSMACA_AC_BE),
     m_rtsSendThreshold (1000),
+    m_adaptiveRts (false),
+    m_maxRtsWindow (16),
+    m_currentRts (false),
     m_resendRtsNum (0),
     m_resendRtsMax (7),
     m_resendDataNum (0),
     m_resendDataMax (7),
-    m_cwMin (15),
-    m_cwMax (1023),
-    m_cw (m_cwMin),
-    m_backoffSlots (0),
     m_sifs (MicroSeconds (16)),
     m_difs (MicroSeconds (34)),
     m_slotTime (MicroSeconds (9)),
-    m_backoffStart (0),
     m_lastRxStart (0),
     m_lastRxDuration (0),
     m_lastBusyStart (0),
@@ -105,7 +121,7 @@ CsmacaMac::CsmacaMac ()
     m_backoffTimeoutEvent (),
     m_backoffGrantStartEvent()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   CsmacaPreamble preamble;
   CsmacaMacHeader rts;
   rts.SetType (CSMACA_MAC_RTS);
@@ -113,21 +129,41 @@ CsmacaMac::CsmacaMac ()
   cts.SetType (CSMACA_MAC_CTS);
   CsmacaMacHeader ack;
   ack.SetType (CSMACA_MAC_ACK);
+  CsmacaMacHeader blockAck;
+  blockAck.SetType (CSMACA_MAC_BLOCK_ACK);
+  CsmacaBlockAckHeader blockAckBody;
   CsmacaMacTrailer fcs;
 
   Time rtsDuration = Seconds (double(rts.GetSize () + fcs.GetSize ()) / preamble.GetRate ()) + preamble.GetDuration ();
   Time ctsDuration = Seconds (double(cts.GetSize () + fcs.GetSize ()) / preamble.GetRate ()) + preamble.GetDuration ();
   Time ackDuration = Seconds (double(ack.GetSize () + fcs.GetSize ()) / preamble.GetRate ()) + preamble.GetDuration ();
+  Time blockAckDuration = Seconds (double(blockAck.GetSize () + blockAckBody.GetSerializedSize () + fcs.GetSize ()) /
+                                   preamble.GetRate ()) + preamble.GetDuration ();
 
   m_maxPropagationDelay = Seconds (1000.0 / 300000000.0);
   m_rtsSendAndSifsTime = rtsDuration + m_maxPropagationDelay + m_sifs;
   m_ctsSendAndSifsTime = ctsDuration + m_maxPropagationDelay + m_sifs;
   m_ackSendAndSifsTime = ackDuration + m_maxPropagationDelay + m_sifs;
-
-  SetPhy (CreateObject<CsmacaPhy> ());
-  SetQueue (CreateObject<CsmacaMacQueue> ());
+  m_blockAckSendAndSifsTime = blockAckDuration + m_maxPropagationDelay + m_sifs;
+
+  // Best effort keeps the DCF parameters, so that unmarked traffic is
+  // served as before; the other categories follow IEEE 802.11e
+  m_acs.resize (CSMACA_AC_N);
+  m_parked.resize (CSMACA_AC_N);
+  m_requeued.resize (CSMACA_AC_N);
+  for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+    {
+      m_acs[i] = CreateObject<CsmacaAccessCategory> ();
+    }
+  m_acs[CSMACA_AC_BK]->SetAifsn (7);
+  m_acs[CSMACA_AC_VI]->SetMinCw (7);
+  m_acs[CSMACA_AC_VI]->SetMaxCw (15);
+  m_acs[CSMACA_AC_VI]->SetTxopLimit (MicroSeconds (3008));
+  m_acs[CSMACA_AC_VO]->SetMinCw (3);
+  m_acs[CSMACA_AC_VO]->SetMaxCw (7);
+  m_acs[CSMACA_AC_VO]->SetTxopLimit (MicroSeconds (1504));
+  m_queue = m_acs[CSMACA_AC_BE]->GetQueue ();
   m_rng = new CsmacaRealRandomStream ();
-  SetupPhyCsmacaMacListener (GetPhy ()->GetPhyStateHelper ());
 }
 
 TypeId
@@ -135,10 +171,73 @@ CsmacaMac::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::CsmacaMac")
     .SetParent<Object> ()
+    .AddConstructor<CsmacaMac> ()
     .AddAttribute ("Rate", "Rate for send.",
                    UintegerValue (6000000 / 8),
                    MakeUintegerAccessor (&CsmacaMac::m_rate),
                    MakeUintegerChecker<uint32_t>(0))
+    .AddAttribute ("MaxAmpduSize", "Maximum size of an aggregated frame in bytes. "
+                   "0 disables aggregation.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaMac::m_maxAmpduSize),
+                   MakeUintegerChecker<uint32_t>(0, 65535))
+    .AddAttribute ("FragmentationThreshold", "Unicast frames larger than this size in bytes "
+                   "are sent as a burst of fragments. 0 disables fragmentation.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaMac::m_fragmentationThreshold),
+                   MakeUintegerChecker<uint32_t>(0, 65535))
+    .AddAttribute ("RtsThreshold", "Unicast frames of at least this size in bytes "
+                   "are protected by RTS/CTS when AdaptiveRts is off.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&CsmacaMac::m_rtsSendThreshold),
+                   MakeUintegerChecker<uint32_t>(0))
+    .AddAttribute ("AdaptiveRts", "Decide RTS/CTS protection per destination "
+                   "from the losses of unprotected frames instead of RtsThreshold.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CsmacaMac::m_adaptiveRts),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRtsWindow", "Maximum number of consecutive frames protected "
+                   "by RTS/CTS after losses in adaptive mode.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&CsmacaMac::m_maxRtsWindow),
+                   MakeUintegerChecker<uint32_t>(1))
+    .AddAttribute ("SaturationSource", "Synthesize a frame whenever the MAC would run out "
+                   "of frames, without going through the upper layers.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CsmacaMac::m_saturation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SaturationPacketSize", "Payload size in bytes of the synthesized frames.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&CsmacaMac::m_saturationPacketSize),
+                   MakeUintegerChecker<uint32_t> (0, 65535))
+    .AddAttribute ("SaturationDestination", "Receiver of the synthesized frames, which must be "
+                   "set to a unicast address when SaturationSource is enabled: broadcast frames "
+                   "get no acknowledgment, retry or aggregation.",
+                   Mac48AddressValue (Mac48Address::GetBroadcast ()),
+                   MakeMac48AddressAccessor (&CsmacaMac::m_saturationDestination),
+                   MakeMac48AddressChecker ())
+    .AddAttribute ("VO_AccessCategory", "The voice access category.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmacaMac::GetVOAccessCategory),
+                   MakePointerChecker<CsmacaAccessCategory> ())
+    .AddAttribute ("VI_AccessCategory", "The video access category.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmacaMac::GetVIAccessCategory),
+                   MakePointerChecker<CsmacaAccessCategory> ())
+    .AddAttribute ("BE_AccessCategory", "The best effort access category.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmacaMac::GetBEAccessCategory),
+                   MakePointerChecker<CsmacaAccessCategory> ())
+    .AddAttribute ("BK_AccessCategory", "The background access category.",
+                   PointerValue (),
+                   MakePointerAccessor (&CsmacaMac::GetBKAccessCategory),
+                   MakePointerChecker<CsmacaAccessCategory> ())
+    .AddTraceSource ("TxOk", "A data frame has been acknowledged, or sent if it needs no acknowledgment",
+                     MakeTraceSourceAccessor (&CsmacaMac::m_txOkTrace))
+    .AddTraceSource ("TxRetry", "A data frame is retransmitted after the given number of failed attempts",
+                     MakeTraceSourceAccessor (&CsmacaMac::m_txRetryTrace))
+    .AddTraceSource ("TxDrop", "A data frame has been dropped after its last failed attempt",
+                     MakeTraceSourceAccessor (&CsmacaMac::m_txDropTrace))
   ;
 
   return tid;
@@ -147,19 +246,53 @@ CsmacaMac::GetTypeId (void)
 int64_t
 CsmacaMac::AssignStreams (int64_t stream)
 {
-  NS_LOG_FUNCTION (this << stream);
+  CSMACA_LOG_FUNCTION (this << stream);
   m_rng->AssignStreams (stream);
   return 1;
 }
 
 CsmacaMac::~CsmacaMac ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
+}
+
+void
+CsmacaMac::DoDispose (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (m_phy != 0 && m_phy->GetPhyStateHelper () != 0)
+    {
+      m_phy->GetPhyStateHelper ()->UnregisterListener (m_phyCsmacaMacListener);
+    }
+  delete m_phyCsmacaMacListener;
+  m_phyCsmacaMacListener = 0;
+  delete m_rng;
+  m_rng = 0;
+  m_phy = 0;
+  m_device = 0;
+  Object::DoDispose ();
+}
+
+void
+CsmacaMac::DoInitialize (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  GetPhy ();
+  // A saturation source has to start contending without any Enqueue
+  StartBackoffIfNeeded ();
+  Object::DoInitialize ();
 }
 
 void
 CsmacaMac::SetPhy (Ptr<CsmacaPhy> phy){
+  if (m_phy != 0)
+    {
+      m_phy->GetPhyStateHelper ()->UnregisterListener (m_phyCsmacaMacListener);
+      delete m_phyCsmacaMacListener;
+      m_phyCsmacaMacListener = 0;
+    }
   m_phy = phy;
+  SetupPhyCsmacaMacListener (m_phy->GetPhyStateHelper ());
 }
 
 void
@@ -169,7 +302,11 @@ CsmacaMac::SetNetDevice (Ptr<CsmacaNetDevice> device){
 
 void
 CsmacaMac::SetQueue (Ptr<CsmacaMacQueue> queue){
-  m_queue = queue;
+  m_acs[CSMACA_AC_BE]->SetQueue (queue);
+  if (m_currentAc == CSMACA_AC_BE)
+    {
+      m_queue = queue;
+    }
 }
 void
 CsmacaMac::SetAddress (Mac48Address address){
@@ -177,12 +314,47 @@ CsmacaMac::SetAddress (Mac48Address address){
 }
 Ptr<CsmacaPhy>
 CsmacaMac::GetPhy (){
+  if (m_phy == 0)
+    {
+      // Only built when nothing, e.g. a helper, supplied a PHY
+      SetPhy (CreateObject<CsmacaPhy> ());
+    }
   return m_phy;
 }
 
 Ptr<CsmacaMacQueue>
 CsmacaMac::GetQueue (){
-  return m_queue;
+  return m_acs[CSMACA_AC_BE]->GetQueue ();
+}
+
+Ptr<CsmacaAccessCategory>
+CsmacaMac::GetAccessCategory (enum CsmacaAcIndex ac) const
+{
+  return m_acs[ac];
+}
+
+Ptr<CsmacaAccessCategory>
+CsmacaMac::GetVOAccessCategory (void) const
+{
+  return GetAccessCategory (CSMACA_AC_VO);
+}
+
+Ptr<CsmacaAccessCategory>
+CsmacaMac::GetVIAccessCategory (void) const
+{
+  return GetAccessCategory (CSMACA_AC_VI);
+}
+
+Ptr<CsmacaAccessCategory>
+CsmacaMac::GetBEAccessCategory (void) const
+{
+  return GetAccessCategory (CSMACA_AC_BE);
+}
+
+Ptr<CsmacaAccessCategory>
+CsmacaMac::GetBKAccessCategory (void) const
+{
+  return GetAccessCategory (CSMACA_AC_BK);
 }
 
 Mac48Address
@@ -200,7 +372,8 @@ CsmacaMac::SetupPhyCsmacaMacListener (Ptr<CsmacaPhyStateHelper> state)
 void
 CsmacaMac::NotifyMaybeCcaBusyStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  CSMACA_LOG_FUNCTION (this << duration);
+  NotifyMediumBusyStart ();
   m_lastBusyStart = Simulator::Now ();
   m_lastBusyDuration = duration;
 }
@@ -208,7 +381,8 @@ CsmacaMac::NotifyMaybeCcaBusyStartNow (Time duration)
 void
 CsmacaMac::NotifyTxStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
+  NotifyMediumBusyStart ();
   if (m_rxing)
     {
       NS_ASSERT (Simulator::Now () - m_lastRxStart <= m_sifs);
@@ -222,16 +396,34 @@ CsmacaMac::NotifyTxStartNow (Time duration)
 void
 CsmacaMac::NotifyRxStartNow (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration);
+  CSMACA_LOG_FUNCTION (this << duration);
+  NotifyMediumBusyStart ();
   m_lastRxStart = Simulator::Now ();
   m_lastRxDuration = duration;
   m_rxing = true;
 }
 
+void
+CsmacaMac::NotifyMediumBusyStart (void)
+{
+  // Idle slots are counted from the end of DIFS, as the contention
+  // window policies expect
+  Time idle = Simulator::Now () - GetSendGrantStart () - m_difs;
+  if (idle.IsStrictlyNegative ())
+    {
+      return;
+    }
+  uint32_t idleSlots = idle.GetMicroSeconds () / m_slotTime.GetMicroSeconds ();
+  for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+    {
+      m_acs[i]->NotifyTransmission (idleSlots);
+    }
+}
+
 Time
 CsmacaMac::GetBackoffGrantStart (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   Time rxBackoffStart = m_lastRxStart + m_lastRxDuration + m_difs;
   Time txBackoffStart = m_lastTxStart + m_lastTxDuration + m_difs;
@@ -245,13 +437,13 @@ CsmacaMac::GetBackoffGrantStart (void) const
   backoffGrantedStart = Max (backoffGrantedStart, ackTimeoutBackoffStart);
   backoffGrantedStart = Max (backoffGrantedStart, ctsTimeoutBackoffStart);
                                         
-  NS_LOG_INFO ("access grant start="  << backoffGrantedStart <<
+  CSMACA_LOG_INFO ("access grant start="  << backoffGrantedStart <<
                ", rx start="   << rxBackoffStart   <<
                ", tx start="   << txBackoffStart    <<
                ", busy start=" << busyBackoffStart <<
                ", nav start="  << navBackoffStart  <<
                ", ack timeout start="  << ackTimeoutBackoffStart << 
-               ", cts timeout start="  << ackTimeoutBackoffStart
+               ", cts timeout start="  << ctsTimeoutBackoffStart
 	       );
   return backoffGrantedStart;
 }
@@ -259,7 +451,7 @@ CsmacaMac::GetBackoffGrantStart (void) const
 Time
 CsmacaMac::GetSendGrantStart (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   Time rxSendStart = m_lastRxStart + m_lastRxDuration;
   Time txSendStart = m_lastTxStart + m_lastTxDuration;
@@ -273,7 +465,7 @@ CsmacaMac::GetSendGrantStart (void) const
   sendGrantedStart = Max (sendGrantedStart, ackTimeoutSendStart);
   sendGrantedStart = Max (sendGrantedStart, ctsTimeoutSendStart);
                                         
-  NS_LOG_INFO ("access grant start="  << sendGrantedStart <<
+  CSMACA_LOG_INFO ("access grant start="  << sendGrantedStart <<
                ", rx start="   << rxSendStart   <<
                ", tx start="   << txSendStart    <<
                ", busy start=" << busySendStart <<
@@ -284,33 +476,40 @@ CsmacaMac::GetSendGrantStart (void) const
   return sendGrantedStart;
 }
 
+void
+CsmacaMac::NotifyQueueDequeued ()
+{
+  if (m_device != 0)
+    {
+      m_device->NotifyQueueDequeued (m_currentAc);
+    }
+}
+
 void
 CsmacaMac::UpdateCw ()
 {
-  m_cw = std::min ( 2 * (m_cw + 1) - 1, m_cwMax);
-  m_backoffSlots = m_rng->GetNext (0, m_cw);
-  m_backoffStart = Simulator::Now ();
+  m_acs[m_currentAc]->NotifyFailure ();
 }
 
 void
 CsmacaMac::InitSend ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   m_resendRtsNum = 0;
   m_resendDataNum = 0;
   m_currentPacket = 0;
-  m_cw = m_cwMin;
+  m_aggregate.clear ();
+  m_currentAmpdu = false;
+  m_fragmentNumber = 0;
+  NotifyQueueDequeued ();
+  RefillSaturationSource ();
 }
 
 Time
 CsmacaMac::CalculateDataSendTime (CsmacaPreamble preamble)
 {
-  NS_LOG_FUNCTION (this);
-  CsmacaMacTrailer fcs;
-  uint32_t dataSize =
-    m_currentPacket->GetSize () +
-    m_currentHdr.GetSize () +
-    fcs.GetSize ();
+  CSMACA_LOG_FUNCTION (this);
+  uint32_t dataSize = GetCurrentPsduSize ();
   Time txDuration =
     Seconds((double)dataSize / preamble.GetRate ()) +
     preamble.GetDuration () +
@@ -318,16 +517,479 @@ CsmacaMac::CalculateDataSendTime (CsmacaPreamble preamble)
   return txDuration;
 }
 
+Time
+CsmacaMac::GetResponseSendAndSifsTime (void) const
+{
+  return m_currentAmpdu ? m_blockAckSendAndSifsTime : m_ackSendAndSifsTime;
+}
+
+uint16_t
+CsmacaMac::GetNextSequenceNumberFor (Mac48Address dest)
+{
+  std::map<Mac48Address, uint16_t>::const_iterator it = m_txSequences.find (dest);
+  return it == m_txSequences.end () ? 0 : it->second;
+}
+
+void
+CsmacaMac::AssignSequenceNumber (CsmacaMacHeader *hdr)
+{
+  // A retransmitted MPDU keeps its sequence number
+  if (hdr->IsRetry ())
+    {
+      return;
+    }
+  uint16_t seq = GetNextSequenceNumberFor (hdr->GetAddr1 ());
+  hdr->SetSequenceNumber (seq);
+  m_txSequences[hdr->GetAddr1 ()] = (seq + 1) & 0x0fff;
+}
+
+bool
+CsmacaMac::NeedBlockAckReq (void) const
+{
+  if (!m_currentAmpdu)
+    {
+      return false;
+    }
+  std::map<Mac48Address, CsmacaOriginatorBlockAckAgreement>::const_iterator it =
+    m_originatorAgreements.find (m_currentHdr.GetAddr1 ());
+  return it == m_originatorAgreements.end () || it->second.NeedBlockAckReq ();
+}
+
+bool
+CsmacaMac::IsDuplicate (const CsmacaMacHeader &hdr)
+{
+  std::map<Mac48Address, uint16_t>::iterator it = m_rxSequences.find (hdr.GetAddr2 ());
+  if (it != m_rxSequences.end ())
+    {
+      if (hdr.IsRetry () && it->second == hdr.GetSequenceControl ())
+        {
+          return true;
+        }
+      it->second = hdr.GetSequenceControl ();
+      return false;
+    }
+  m_rxSequences.insert (std::make_pair (hdr.GetAddr2 (), hdr.GetSequenceControl ()));
+  return false;
+}
+
+bool
+CsmacaMac::NeedFragmentation (void) const
+{
+  CsmacaMacTrailer fcs;
+  return m_fragmentationThreshold > 0 &&
+         !m_currentHdr.GetAddr1 ().IsGroup () &&
+         m_currentPacket->GetSize () + m_currentHdr.GetSize () + fcs.GetSize () > m_fragmentationThreshold;
+}
+
+bool
+CsmacaMac::IsLastFragment (void) const
+{
+  return (m_fragmentNumber + 1) * GetFragmentSize (0) >= m_currentPacket->GetSize ();
+}
+
+uint32_t
+CsmacaMac::GetFragmentSize (uint32_t fragmentNumber) const
+{
+  CsmacaMacTrailer fcs;
+  uint32_t overhead = m_currentHdr.GetSize () + fcs.GetSize ();
+  uint32_t size = m_currentPacket->GetSize ();
+  uint32_t fragmentSize = m_fragmentationThreshold > overhead ? m_fragmentationThreshold - overhead : 1;
+  // The fragment number field limits an MSDU to 16 fragments
+  fragmentSize = std::max (fragmentSize, (size + 15) / 16);
+  uint32_t offset = fragmentNumber * fragmentSize;
+  NS_ASSERT (offset < size);
+  return std::min (fragmentSize, size - offset);
+}
+
+Time
+CsmacaMac::CalculateFragmentSendTime (uint32_t fragmentNumber, CsmacaPreamble preamble) const
+{
+  CsmacaMacTrailer fcs;
+  uint32_t dataSize = GetFragmentSize (fragmentNumber) + m_currentHdr.GetSize () + fcs.GetSize ();
+  return Seconds ((double)dataSize / preamble.GetRate ()) +
+         preamble.GetDuration () +
+         m_maxPropagationDelay;
+}
+
+Ptr<Packet>
+CsmacaMac::Reassemble (Ptr<Packet> packet, const CsmacaMacHeader &hdr)
+{
+  CSMACA_LOG_FUNCTION (this << packet << hdr.GetSequenceNumber () << (uint32_t)hdr.GetFragmentNumber ());
+  if (hdr.GetFragmentNumber () == 0 && !hdr.IsMoreFragments ())
+    {
+      return packet;
+    }
+  Mac48Address source = hdr.GetAddr2 ();
+  if (hdr.GetFragmentNumber () == 0)
+    {
+      Reassembly reassembly;
+      reassembly.seq = hdr.GetSequenceNumber ();
+      reassembly.nextFragment = 1;
+      reassembly.packet = packet->Copy ();
+      m_reassembly[source] = reassembly;
+      return 0;
+    }
+
+  std::map<Mac48Address, Reassembly>::iterator it = m_reassembly.find (source);
+  if (it == m_reassembly.end () ||
+      it->second.seq != hdr.GetSequenceNumber () ||
+      it->second.nextFragment != hdr.GetFragmentNumber ())
+    {
+      // A retransmitted fragment, or the rest of an MSDU whose first fragment was missed
+      CSMACA_LOG_DEBUG ("unexpected fragment " << hdr);
+      return 0;
+    }
+  if (it->second.packet->GetSize () + packet->GetSize () > 0xffff)
+    {
+      CSMACA_LOG_DEBUG ("reassembled MSDU too large, dropped");
+      m_reassembly.erase (it);
+      return 0;
+    }
+  it->second.packet->AddAtEnd (packet);
+  it->second.nextFragment++;
+  if (hdr.IsMoreFragments ())
+    {
+      return 0;
+    }
+  Ptr<Packet> msdu = it->second.packet;
+  m_reassembly.erase (it);
+  return msdu;
+}
+
+Time
+CsmacaMac::GetTxopRemaining (void) const
+{
+  return m_txopStart + m_txopLimit - Simulator::Now ();
+}
+
+bool
+CsmacaMac::FitsInTxop (Time txDuration, Time responseDuration, bool rts) const
+{
+  Time duration = m_sifs + txDuration + responseDuration;
+  if (rts)
+    {
+      duration += m_rtsSendAndSifsTime + m_ctsSendAndSifsTime;
+    }
+  return duration <= GetTxopRemaining ();
+}
+
+bool
+CsmacaMac::ContinueTxop ()
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (m_txopLimit.IsZero () || m_currentPacket != 0 || m_queue->IsEmpty ())
+    {
+      return false;
+    }
+  CsmacaMacHeader hdr;
+  Ptr<const Packet> packet = m_queue->Peek (&hdr);
+  if (hdr.GetAddr1 ().IsGroup ())
+    {
+      return false;
+    }
+
+  // The first MPDU, or first fragment, and its response must end inside the TXOP
+  CsmacaPreamble preamble;
+  preamble.SetRate (m_rate);
+  CsmacaMacTrailer fcs;
+  uint32_t size = packet->GetSize () + hdr.GetSize () + fcs.GetSize ();
+  if (m_fragmentationThreshold > 0)
+    {
+      size = std::min (size, m_fragmentationThreshold);
+    }
+  Time txDuration =
+    Seconds ((double)size / preamble.GetRate ()) +
+    preamble.GetDuration () +
+    m_maxPropagationDelay;
+  Time responseDuration = m_maxAmpduSize > 0 ? m_blockAckSendAndSifsTime : m_ackSendAndSifsTime;
+  if (!FitsInTxop (txDuration, responseDuration, false))
+    {
+      return false;
+    }
+
+  m_currentPacket = m_queue->Dequeue (&m_currentHdr);
+  AssignSequenceNumber (&m_currentHdr);
+  AggregateCurrentPacket (false);
+  NotifyQueueDequeued ();
+  m_currentRts = false;
+  CSMACA_LOG_DEBUG ("continue TXOP, remaining=" << GetTxopRemaining ());
+  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+  m_sendDataAfterCtsEvent = Simulator::Schedule (m_sifs,
+                                                 &CsmacaMac::SendDataAfterCts,
+                                                 this);
+  return true;
+}
+
+bool
+CsmacaMac::WouldNeedRts (Mac48Address dest, uint32_t size) const
+{
+  if (!m_adaptiveRts)
+    {
+      return m_rtsSendThreshold <= size;
+    }
+  std::map<Mac48Address, RtsState>::const_iterator it = m_rtsStates.find (dest);
+  return it != m_rtsStates.end () && it->second.counter > 0;
+}
+
+bool
+CsmacaMac::NeedRts (Mac48Address dest, uint32_t size)
+{
+  if (!WouldNeedRts (dest, size))
+    {
+      return false;
+    }
+  if (m_adaptiveRts)
+    {
+      m_rtsStates[dest].counter--;
+    }
+  return true;
+}
+
+void
+CsmacaMac::NotifyRtsOutcome (bool success)
+{
+  CSMACA_LOG_FUNCTION (this << success);
+  if (!m_adaptiveRts || m_currentHdr.GetAddr1 ().IsGroup ())
+    {
+      return;
+    }
+  Mac48Address dest = m_currentHdr.GetAddr1 ();
+  if (m_currentRts)
+    {
+      if (!success)
+        {
+          // The retry must stay protected: give back the frame taken
+          // from the window when RTS was chosen
+          std::map<Mac48Address, RtsState>::iterator it = m_rtsStates.find (dest);
+          if (it != m_rtsStates.end ())
+            {
+              it->second.counter = std::min (it->second.counter + 1, it->second.window);
+            }
+        }
+      return;
+    }
+  RtsState &state = m_rtsStates[dest];
+  if (success)
+    {
+      state.window /= 2;
+      state.counter = std::min (state.counter, state.window);
+    }
+  else
+    {
+      state.window = std::min (state.window + 1, m_maxRtsWindow);
+      state.counter = state.window;
+    }
+  CSMACA_LOG_DEBUG ("dest=" << dest << ", rts window=" << state.window);
+}
+
+void
+CsmacaMac::NotifyCurrentPacketDiscarded ()
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (m_currentPacket != 0)
+    {
+      m_txDropTrace (m_currentPacket, m_currentHdr);
+    }
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::const_iterator i = m_aggregate.begin ();
+       i != m_aggregate.end (); i++)
+    {
+      m_txDropTrace (i->first, i->second);
+    }
+  std::map<Mac48Address, CsmacaOriginatorBlockAckAgreement>::iterator it =
+    m_originatorAgreements.find (m_currentHdr.GetAddr1 ());
+  if (m_currentPacket == 0 || it == m_originatorAgreements.end ())
+    {
+      return;
+    }
+  // The recipient may wait for these MPDUs in its reordering buffer
+  it->second.NotifyDiscarded (m_currentHdr.GetSequenceNumber ());
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::const_iterator i = m_aggregate.begin ();
+       i != m_aggregate.end (); i++)
+    {
+      it->second.NotifyDiscarded (i->second.GetSequenceNumber ());
+    }
+}
+
+void
+CsmacaMac::AggregateCurrentPacket (bool firstInTxop)
+{
+  CSMACA_LOG_FUNCTION (this << firstInTxop);
+  // Fragments are never aggregated
+  if (m_maxAmpduSize == 0 || m_currentHdr.GetAddr1 ().IsGroup () || NeedFragmentation ())
+    {
+      return;
+    }
+  if (!m_currentAmpdu)
+    {
+      // Even a single MPDU is sent as an aggregated frame, so that every
+      // unicast frame to the recipient goes through the block ack agreement
+      m_currentAmpdu = true;
+      if (GetCurrentAmpduSize () > m_maxAmpduSize)
+        {
+          m_currentAmpdu = false;
+          return;
+        }
+    }
+
+  CsmacaPreamble preamble;
+  preamble.SetRate (m_rate);
+  CsmacaMacTrailer fcs;
+  Mac48Address dest = m_currentHdr.GetAddr1 ();
+  uint32_t ampduSize = GetCurrentAmpduSize ();
+  CsmacaMacHeader hdr;
+  Ptr<const Packet> packet;
+  while ((packet = m_queue->PeekByAddress (&hdr, dest)) != 0)
+    {
+      // The MPDUs of an aggregate must fit in the BlockAck bitmap
+      uint16_t seq = hdr.IsRetry () ? hdr.GetSequenceNumber () : GetNextSequenceNumberFor (dest);
+      if (CsmacaGetSequenceDistance (seq, m_currentHdr.GetSequenceNumber ()) >= CSMACA_BLOCK_ACK_WINDOW_SIZE)
+        {
+          break;
+        }
+      // A requeued frame goes out as the head of its own aggregate
+      if (IsRequeued (packet))
+        {
+          break;
+        }
+      uint32_t mpduSize = packet->GetSize () + hdr.GetSize () + fcs.GetSize ();
+      uint32_t nextSize = CsmacaMpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize);
+      Time txDuration =
+        Seconds ((double)nextSize / preamble.GetRate ()) +
+        preamble.GetDuration () +
+        m_maxPropagationDelay;
+      // The whole exchange has to fit in the duration field, and in the
+      // TXOP under the same rule as a head frame sent in ContinueTxop
+      bool rts = firstInTxop && WouldNeedRts (dest, nextSize);
+      if (nextSize > m_maxAmpduSize ||
+          m_ctsSendAndSifsTime + txDuration + m_blockAckSendAndSifsTime > MicroSeconds (0x7fff) ||
+          (!m_txopLimit.IsZero () && !FitsInTxop (txDuration, m_blockAckSendAndSifsTime, rts)))
+        {
+          break;
+        }
+      m_queue->DequeueByAddress (&hdr, dest);
+      AssignSequenceNumber (&hdr);
+      m_aggregate.push_back (std::make_pair (packet, hdr));
+      ampduSize = nextSize;
+    }
+  CSMACA_LOG_DEBUG ("aggregated " << m_aggregate.size () + 1 << " MPDUs, size=" << ampduSize);
+}
+
+uint32_t
+CsmacaMac::GetCurrentPsduSize (void) const
+{
+  if (!m_currentAmpdu)
+    {
+      CsmacaMacTrailer fcs;
+      uint32_t size = NeedFragmentation () ? GetFragmentSize (m_fragmentNumber) : m_currentPacket->GetSize ();
+      return size + m_currentHdr.GetSize () + fcs.GetSize ();
+    }
+  return GetCurrentAmpduSize ();
+}
+
+uint32_t
+CsmacaMac::GetCurrentAmpduSize (void) const
+{
+  CsmacaMacTrailer fcs;
+  uint32_t size = 0;
+  if (NeedBlockAckReq ())
+    {
+      CsmacaMacHeader bar;
+      bar.SetType (CSMACA_MAC_BLOCK_ACK_REQ);
+      CsmacaBlockAckReqHeader barBody;
+      size = CsmacaMpduAggregator::GetSizeIfAggregated (bar.GetSize () + barBody.GetSerializedSize () +
+                                                        fcs.GetSize (), size);
+    }
+  size = CsmacaMpduAggregator::GetSizeIfAggregated (m_currentPacket->GetSize () +
+                                                    m_currentHdr.GetSize () +
+                                                    fcs.GetSize (), size);
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::const_iterator i = m_aggregate.begin ();
+       i != m_aggregate.end (); i++)
+    {
+      uint32_t mpduSize = i->first->GetSize () + i->second.GetSize () + fcs.GetSize ();
+      size = CsmacaMpduAggregator::GetSizeIfAggregated (mpduSize, size);
+    }
+  return size;
+}
+
+Ptr<Packet>
+CsmacaMac::GetCurrentPsdu (Time duration, CsmacaPreamble *preamble)
+{
+  CSMACA_LOG_FUNCTION (this << duration);
+  CsmacaMacTrailer fcs;
+
+  Ptr<Packet> packet;
+  if (NeedFragmentation ())
+    {
+      packet = m_currentPacket->CreateFragment (m_fragmentNumber * GetFragmentSize (0),
+                                                GetFragmentSize (m_fragmentNumber));
+      m_currentHdr.SetFragmentNumber (m_fragmentNumber);
+      if (IsLastFragment ())
+        {
+          m_currentHdr.SetNoMoreFragments ();
+        }
+      else
+        {
+          m_currentHdr.SetMoreFragments ();
+        }
+    }
+  else
+    {
+      packet = m_currentPacket->Copy ();
+    }
+  m_currentHdr.SetDuration (duration);
+  packet->AddHeader (m_currentHdr);
+  packet->AddTrailer (fcs);
+
+  preamble->SetAggregation (m_currentAmpdu);
+  if (!m_currentAmpdu)
+    {
+      return packet;
+    }
+
+  Ptr<Packet> ampdu = Create<Packet> ();
+  CSMACA_COUNT (MAC_ALLOCATIONS);
+  if (NeedBlockAckReq ())
+    {
+      // Opens the agreement, or moves the window of the recipient
+      // to the oldest MPDU which is still outstanding
+      CsmacaBlockAckReqHeader barBody;
+      barBody.SetStartingSequence (m_currentHdr.GetSequenceNumber ());
+      CsmacaMacHeader bar;
+      bar.SetType (CSMACA_MAC_BLOCK_ACK_REQ);
+      bar.SetAddr1 (m_currentHdr.GetAddr1 ());
+      bar.SetAddr2 (GetAddress ());
+      bar.SetDuration (duration);
+
+      Ptr<Packet> mpdu = Create<Packet> ();
+      CSMACA_COUNT (MAC_ALLOCATIONS);
+      mpdu->AddHeader (barBody);
+      mpdu->AddHeader (bar);
+      mpdu->AddTrailer (fcs);
+      CsmacaMpduAggregator::Aggregate (mpdu, ampdu);
+    }
+  CsmacaMpduAggregator::Aggregate (packet, ampdu);
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::iterator i = m_aggregate.begin ();
+       i != m_aggregate.end (); i++)
+    {
+      Ptr<Packet> mpdu = i->first->Copy ();
+      i->second.SetDuration (duration);
+      mpdu->AddHeader (i->second);
+      mpdu->AddTrailer (fcs);
+      CsmacaMpduAggregator::Aggregate (mpdu, ampdu);
+    }
+  return ampdu;
+}
+
 void
 CsmacaMac::ReceiveOk (Ptr<Packet> packet)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   m_rxing = false;
 
   CsmacaMacHeader hdr;
   packet->RemoveHeader (hdr);
-  NS_LOG_DEBUG (hdr);
+  CSMACA_LOG_DEBUG (hdr);
 
   // Set Nav
   if (hdr.GetAddr1 () != GetAddress ())
@@ -339,29 +1001,83 @@ CsmacaMac::ReceiveOk (Ptr<Packet> packet)
   switch (hdr.GetType ())
     {
     case CSMACA_MAC_DATA:
+      {
+        CsmacaMacTrailer fcs;
+        packet->RemoveTrailer (fcs);
+      }
       if (hdr.GetAddr1 () == GetAddress () && !hdr.GetAddr1 ().IsGroup ())
 	{
+	  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
 	  m_sendAckAfterDataEvent = Simulator::Schedule (m_sifs,
 							 &CsmacaMac::SendAckAfterData,
 							 this,
 							 hdr.GetAddr2 ());
+	  // Frames sent outside of an aggregate still take their place
+	  // in the reordering buffer of the agreement
+	  std::map<Mac48Address, CsmacaRecipientBlockAckAgreement>::iterator it =
+	    m_recipientAgreements.find (hdr.GetAddr2 ());
+	  if (it != m_recipientAgreements.end ())
+	    {
+	      packet = Reassemble (packet, hdr);
+	      if (packet != 0)
+		{
+		  CsmacaRecipientBlockAckAgreement::Mpdus released;
+		  it->second.NotifyReceivedMpdu (packet, hdr, &released);
+		  ForwardUp (released);
+		}
+	      break;
+	    }
+	  // The ACK is sent again, but the frame is delivered only once
+	  if (IsDuplicate (hdr))
+	    {
+	      CSMACA_LOG_DEBUG ("duplicate " << hdr);
+	      break;
+	    }
+	  packet = Reassemble (packet, hdr);
+	  if (packet == 0)
+	    {
+	      break;
+	    }
+	}
+      else if (hdr.GetFragmentNumber () != 0 || hdr.IsMoreFragments ())
+	{
+	  // overheard fragments are not reassembled
+	  break;
 	}
-      m_device->Receive (packet, hdr.GetAddr1 (), hdr.GetAddr2 ());
+      m_device->Receive (packet, hdr.GetDestination (), hdr.GetSource ());
       break;
       
     case CSMACA_MAC_ACK:
-      if (hdr.GetAddr1 () == GetAddress ())
+      if (hdr.GetAddr1 () == GetAddress () && m_ackTimeoutEvent.IsRunning ())
 	{
 	  m_ackTimeoutEvent.Cancel ();
 	  m_lastAckTimeoutEnd = Simulator::Now ();
+	  if (NeedFragmentation () && !IsLastFragment ())
+	    {
+	      // The next fragment follows after SIFS, inside the NAV set by this one
+	      m_fragmentNumber++;
+	      m_currentHdr.SetNoRetry ();
+	      CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+	      m_sendDataAfterCtsEvent = Simulator::Schedule (m_sifs,
+							     &CsmacaMac::SendDataAfterCts,
+							     this);
+	      break;
+	    }
+	  m_acs[m_currentAc]->NotifySuccess ();
+	  NotifyRtsOutcome (true);
+	  m_txOkTrace (m_currentPacket, m_currentHdr);
 	  InitSend ();
-	  StartBackoffIfNeeded ();
+	  if (!ContinueTxop ())
+	    {
+	      StartBackoffIfNeeded ();
+	    }
 	}
       break;
     
     case CSMACA_MAC_RTS:
       if (hdr.GetAddr1 () == GetAddress ())
 	{
+	  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
 	  m_sendCtsAfterRtsEvent = Simulator::Schedule (m_sifs,
 							&CsmacaMac::SendCtsAfterRts,
 							this,
@@ -371,42 +1087,197 @@ CsmacaMac::ReceiveOk (Ptr<Packet> packet)
       break;
 
     case CSMACA_MAC_CTS:
-      if (hdr.GetAddr1 () == GetAddress ())
+      if (hdr.GetAddr1 () == GetAddress () && m_ctsTimeoutEvent.IsRunning ())
 	{
 	  m_ctsTimeoutEvent.Cancel ();
 	  m_lastCtsTimeoutEnd = Simulator::Now ();
+	  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
 	  m_sendDataAfterCtsEvent = Simulator::Schedule (m_sifs,
 							 &CsmacaMac::SendDataAfterCts,
 							 this);
 	}
       break;
 
+    case CSMACA_MAC_BLOCK_ACK:
+      if (hdr.GetAddr1 () == GetAddress () && m_currentAmpdu && m_ackTimeoutEvent.IsRunning ())
+	{
+	  CsmacaBlockAckHeader blockAck;
+	  packet->RemoveHeader (blockAck);
+	  m_ackTimeoutEvent.Cancel ();
+	  m_lastAckTimeoutEnd = Simulator::Now ();
+	  ReceiveBlockAck (hdr.GetAddr2 (), blockAck);
+	  m_acs[m_currentAc]->NotifySuccess ();
+	  NotifyRtsOutcome (true);
+	  InitSend ();
+	  if (!ContinueTxop ())
+	    {
+	      StartBackoffIfNeeded ();
+	    }
+	}
+      break;
+
+    case CSMACA_MAC_BLOCK_ACK_REQ:
+      // only sent inside aggregated frames
+      break;
     }
 }
 
 void
 CsmacaMac::ReceiveError (Ptr<Packet> packet)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   m_rxing = false;
 
   CsmacaMacHeader hdr;
   packet->RemoveHeader (hdr);
-  NS_LOG_DEBUG (hdr);
+  CSMACA_LOG_DEBUG (hdr);
+}
+
+void
+CsmacaMac::ReceiveAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus, std::vector<bool> statusPerMpdu)
+{
+  CSMACA_LOG_FUNCTION (this << mpdus.size ());
+
+  m_rxing = false;
+
+  bool forMe = false;
+  Mac48Address source;
+  CsmacaRecipientBlockAckAgreement::Mpdus released;
+  std::vector<bool>::const_iterator status = statusPerMpdu.begin ();
+  for (CsmacaMpduAggregator::DeaggregatedMpdusCI i = mpdus.begin (); i != mpdus.end (); i++, status++)
+    {
+      if (!*status)
+        {
+          continue;
+        }
+      Ptr<Packet> packet = i->first;
+      CsmacaMacHeader hdr;
+      packet->RemoveHeader (hdr);
+      CsmacaMacTrailer fcs;
+      packet->RemoveTrailer (fcs);
+      CSMACA_LOG_DEBUG (hdr);
+
+      // Set Nav
+      if (hdr.GetAddr1 () != GetAddress ())
+        {
+          SetNav (hdr.GetDuration ());
+          if (hdr.GetType () == CSMACA_MAC_DATA)
+            {
+              m_device->Receive (packet, hdr.GetDestination (), hdr.GetSource ());
+            }
+          continue;
+        }
+
+      forMe = true;
+      source = hdr.GetAddr2 ();
+      std::map<Mac48Address, CsmacaRecipientBlockAckAgreement>::iterator it =
+        m_recipientAgreements.find (source);
+      if (hdr.GetType () == CSMACA_MAC_BLOCK_ACK_REQ)
+        {
+          CsmacaBlockAckReqHeader bar;
+          packet->RemoveHeader (bar);
+          if (it == m_recipientAgreements.end ())
+            {
+              CSMACA_LOG_DEBUG ("block ack agreement with " << source << ", start=" << bar.GetStartingSequence ());
+              m_recipientAgreements.insert (std::make_pair (source,
+                                                            CsmacaRecipientBlockAckAgreement (bar.GetStartingSequence ())));
+            }
+          else
+            {
+              it->second.NotifyBlockAckReq (bar.GetStartingSequence (), &released);
+            }
+        }
+      else if (hdr.GetType () == CSMACA_MAC_DATA)
+        {
+          if (it != m_recipientAgreements.end ())
+            {
+              it->second.NotifyReceivedMpdu (packet, hdr, &released);
+            }
+          else
+            {
+              // The BlockAckReq opening the agreement was lost: without a
+              // BlockAck the originator sends the whole aggregate again
+              CSMACA_LOG_DEBUG ("no block ack agreement with " << source);
+            }
+        }
+    }
+  ForwardUp (released);
+
+  if (forMe && m_recipientAgreements.find (source) != m_recipientAgreements.end ())
+    {
+      CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+      m_sendAckAfterDataEvent = Simulator::Schedule (m_sifs,
+                                                     &CsmacaMac::SendBlockAckAfterAmpdu,
+                                                     this,
+                                                     source);
+    }
+}
+
+void
+CsmacaMac::ReceiveBlockAck (Mac48Address source, const CsmacaBlockAckHeader &blockAck)
+{
+  CSMACA_LOG_FUNCTION (this << source << blockAck);
+  CsmacaOriginatorBlockAckAgreement &agreement = m_originatorAgreements[source];
+  agreement.NotifyBlockAckReceived ();
+
+  std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> > mpdus = m_aggregate;
+  mpdus.push_front (std::make_pair (m_currentPacket, m_currentHdr));
+  std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> > missed;
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::iterator i = mpdus.begin ();
+       i != mpdus.end (); i++)
+    {
+      uint16_t seq = i->second.GetSequenceNumber ();
+      if (blockAck.IsPacketReceived (seq))
+        {
+          agreement.NotifyAcked (seq);
+          m_txOkTrace (i->first, i->second);
+          continue;
+        }
+      uint32_t misses = agreement.NotifyMissed (seq);
+      if (misses > m_resendDataMax)
+        {
+          CSMACA_LOG_DEBUG ("discard seq=" << seq);
+          agreement.NotifyDiscarded (seq);
+          m_txDropTrace (i->first, i->second);
+        }
+      else
+        {
+          m_txRetryTrace (i->second, misses);
+          i->second.SetRetry ();
+          missed.push_back (*i);
+        }
+    }
+  // Missed MPDUs go back to the head of the queue in sequence order
+  for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::reverse_iterator i = missed.rbegin ();
+       i != missed.rend (); i++)
+    {
+      m_queue->PushFront (i->first, i->second);
+    }
+}
+
+void
+CsmacaMac::ForwardUp (const CsmacaRecipientBlockAckAgreement::Mpdus &mpdus)
+{
+  for (CsmacaRecipientBlockAckAgreement::Mpdus::const_iterator i = mpdus.begin (); i != mpdus.end (); i++)
+    {
+      m_device->Receive (i->first, i->second.GetDestination (), i->second.GetSource ());
+    }
 }
 
 void
 CsmacaMac::SendRts ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   NS_ASSERT (m_ctsTimeoutEvent.IsExpired ());
 
   CsmacaPreamble preamble;
 
   Time timerDelay = m_rtsSendAndSifsTime + m_ctsSendAndSifsTime;
+  m_queue->NotifyAirtime (m_currentHdr.GetAddr1 (), timerDelay);
+  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
   m_ctsTimeoutEvent = Simulator::Schedule (timerDelay, &CsmacaMac::CtsTimeout, this);
   m_lastCtsTimeoutEnd = Simulator::Now () + timerDelay;
-  NS_LOG_DEBUG ("CTS Time out: " << m_lastCtsTimeoutEnd);
+  CSMACA_LOG_DEBUG ("CTS Time out: " << m_lastCtsTimeoutEnd);
 
   Time txDuration = CalculateDataSendTime (preamble);
 
@@ -414,9 +1285,16 @@ CsmacaMac::SendRts ()
   rts.SetType (CSMACA_MAC_RTS);
   rts.SetAddr1 (m_currentHdr.GetAddr1 ());
   rts.SetAddr2 (GetAddress ());
-  rts.SetDuration (m_ctsSendAndSifsTime + txDuration + m_ackSendAndSifsTime);
+  Time duration = m_ctsSendAndSifsTime + txDuration + GetResponseSendAndSifsTime ();
+  if (!m_txopLimit.IsZero ())
+    {
+      // The NAV set by the RTS/CTS protects the whole TXOP
+      duration = Max (duration, Min (GetTxopRemaining (), MicroSeconds (0x7fff)));
+    }
+  rts.SetDuration (duration);
 
   Ptr<Packet> packet = Create<Packet> ();
+  CSMACA_COUNT (MAC_ALLOCATIONS);
   packet->AddHeader (rts);
 
   CsmacaMacTrailer fcs;
@@ -428,7 +1306,7 @@ CsmacaMac::SendRts ()
 void
 CsmacaMac::SendCtsAfterRts (Mac48Address source, Time duration)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   CsmacaPreamble preamble;
 
@@ -438,6 +1316,7 @@ CsmacaMac::SendCtsAfterRts (Mac48Address source, Time duration)
   cts.SetDuration (duration - m_ctsSendAndSifsTime);
 
   Ptr<Packet> packet = Create<Packet> ();
+  CSMACA_COUNT (MAC_ALLOCATIONS);
   packet->AddHeader (cts);
 
   CsmacaMacTrailer fcs;
@@ -449,7 +1328,7 @@ CsmacaMac::SendCtsAfterRts (Mac48Address source, Time duration)
 void
 CsmacaMac::SendDataNoAck ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   CsmacaPreamble preamble;
   preamble.SetRate (m_rate);
@@ -461,8 +1340,12 @@ CsmacaMac::SendDataNoAck ()
   CsmacaMacTrailer fcs;
   packet->AddTrailer (fcs);
 
+  m_queue->NotifyAirtime (m_currentHdr.GetAddr1 (),
+                          Seconds ((double)packet->GetSize () / preamble.GetRate ()) + preamble.GetDuration ());
   m_phy->StartSend (packet, preamble); 
 
+  m_acs[m_currentAc]->NotifySuccess ();
+  m_txOkTrace (m_currentPacket, m_currentHdr);
   InitSend ();
   StartBackoffIfNeeded ();
 }
@@ -470,34 +1353,37 @@ CsmacaMac::SendDataNoAck ()
 void
 CsmacaMac::SendDataAfterCts ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   NS_ASSERT (m_ackTimeoutEvent.IsExpired ());
 
   CsmacaPreamble preamble;
   preamble.SetRate (m_rate);
 
   Time txDuration = CalculateDataSendTime (preamble);
-  Time timerDelay = txDuration + m_ackSendAndSifsTime;
+  Time timerDelay = txDuration + GetResponseSendAndSifsTime ();
+  m_queue->NotifyAirtime (m_currentHdr.GetAddr1 (), timerDelay);
 
+  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
   m_ackTimeoutEvent = Simulator::Schedule (timerDelay, &CsmacaMac::AckTimeout, this);
   m_lastAckTimeoutEnd = Simulator::Now () + timerDelay;
-  NS_LOG_DEBUG ("[ACK Time out] duration=" << timerDelay <<  ", end time=" << m_lastAckTimeoutEnd);
+  CSMACA_LOG_DEBUG ("[ACK Time out] duration=" << timerDelay <<  ", end time=" << m_lastAckTimeoutEnd);
 
-  Ptr<Packet> packet = m_currentPacket->Copy ();
-  m_currentHdr.SetDuration (m_ackSendAndSifsTime);
-  packet->AddHeader (m_currentHdr);
-  
-  CsmacaMacTrailer fcs;
-  packet->AddTrailer (fcs);
+  Time duration = GetResponseSendAndSifsTime ();
+  if (NeedFragmentation () && !IsLastFragment ())
+    {
+      // Reserve the medium for the next fragment and its ACK as well
+      duration += CalculateFragmentSendTime (m_fragmentNumber + 1, preamble) + m_ackSendAndSifsTime;
+    }
+  Ptr<Packet> packet = GetCurrentPsdu (duration, &preamble);
 
-  NS_LOG_DEBUG ("packet Size" << packet->GetSize());
+  CSMACA_LOG_DEBUG ("packet Size" << packet->GetSize());
   m_phy->StartSend (packet, preamble); 
 }
 
 void
 CsmacaMac::SendAckAfterData (Mac48Address source)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 
   CsmacaPreamble preamble;
 
@@ -507,6 +1393,7 @@ CsmacaMac::SendAckAfterData (Mac48Address source)
   ack.SetDuration (Seconds (0));
 
   Ptr<Packet> packet = Create<Packet> ();
+  CSMACA_COUNT (MAC_ALLOCATIONS);
   packet->AddHeader (ack);
 
   CsmacaMacTrailer fcs;
@@ -515,6 +1402,33 @@ CsmacaMac::SendAckAfterData (Mac48Address source)
   m_phy->StartSend (packet, preamble); 
 }
 
+void
+CsmacaMac::SendBlockAckAfterAmpdu (Mac48Address source)
+{
+  CSMACA_LOG_FUNCTION (this << source);
+
+  CsmacaPreamble preamble;
+
+  CsmacaBlockAckHeader blockAck;
+  m_recipientAgreements.find (source)->second.FillBlockAck (&blockAck);
+
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_BLOCK_ACK);
+  hdr.SetAddr1 (source);
+  hdr.SetAddr2 (GetAddress ());
+  hdr.SetDuration (Seconds (0));
+
+  Ptr<Packet> packet = Create<Packet> ();
+  CSMACA_COUNT (MAC_ALLOCATIONS);
+  packet->AddHeader (blockAck);
+  packet->AddHeader (hdr);
+
+  CsmacaMacTrailer fcs;
+  packet->AddTrailer (fcs);
+
+  m_phy->StartSend (packet, preamble); 
+}
+
 void
 CsmacaMac::SetNav (Time duration)
 {
@@ -526,23 +1440,210 @@ CsmacaMac::SetNav (Time duration)
     }
 }
 
-void
+bool
 CsmacaMac::Enqueue (Ptr<Packet const> packet, const CsmacaMacHeader &hdr)
 {
-  NS_LOG_FUNCTION (this);
-  m_queue->Enqueue (packet, hdr);
+  return Enqueue (packet, hdr, CSMACA_AC_BE);
+}
+
+bool
+CsmacaMac::Enqueue (Ptr<Packet const> packet, const CsmacaMacHeader &hdr, enum CsmacaAcIndex ac)
+{
+  CSMACA_LOG_FUNCTION (this << ac);
+  bool joinBackoff = !HasPendingFrames (ac) && m_currentPacket == 0 && m_backoffTimeoutEvent.IsRunning ();
+  if (!m_acs[ac]->GetQueue ()->Enqueue (packet, hdr))
+    {
+      return false;
+    }
+  if (joinBackoff && HasPendingFrames (ac))
+    {
+      // Join the backoff in progress rather than wait for the next one
+      Time end = DrawBackoff (ac);
+      if (end < Simulator::Now () + Simulator::GetDelayLeft (m_backoffTimeoutEvent))
+        {
+          m_backoffTimeoutEvent.Cancel ();
+          CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+          m_backoffTimeoutEvent = Simulator::Schedule (end - Simulator::Now (), &CsmacaMac::BackoffTimeout, this);
+        }
+    }
   StartBackoffIfNeeded ();
+  return true;
+}
+
+bool
+CsmacaMac::HasPendingFrames (enum CsmacaAcIndex ac) const
+{
+  return m_parked[ac].packet != 0 || !m_acs[ac]->GetQueue ()->IsEmpty ();
+}
+
+bool
+CsmacaMac::HasPendingFrames (void) const
+{
+  for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+    {
+      if (HasPendingFrames (static_cast<enum CsmacaAcIndex> (i)))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+CsmacaMac::ParkCurrentPacket ()
+{
+  CSMACA_LOG_FUNCTION (this << m_currentAc);
+  bool requeue = m_queue->IsScheduledPerDestination ();
+  if (requeue)
+    {
+      m_requeued[m_currentAc].push_back (ParkedFrame ());
+    }
+  ParkedFrame &parked = requeue ? m_requeued[m_currentAc].back () : m_parked[m_currentAc];
+  parked.packet = m_currentPacket;
+  parked.hdr = m_currentHdr;
+  parked.aggregate.swap (m_aggregate);
+  parked.ampdu = m_currentAmpdu;
+  parked.fragmentNumber = m_fragmentNumber;
+  parked.resendRtsNum = m_resendRtsNum;
+  parked.resendDataNum = m_resendDataNum;
+  if (requeue)
+    {
+      // The frame and its aggregate already hold sequence numbers which
+      // the recipient waits for: marked as a retransmission, the frame
+      // is neither expired nor dropped by the queue
+      CsmacaMacHeader hdr = m_currentHdr;
+      hdr.SetRetry ();
+      m_queue->PushFront (m_currentPacket, hdr);
+    }
+  m_currentPacket = 0;
+  m_aggregate.clear ();
+}
+
+void
+CsmacaMac::LoadCurrentPacket (enum CsmacaAcIndex ac)
+{
+  CSMACA_LOG_FUNCTION (this << ac);
+  m_currentAc = ac;
+  m_queue = m_acs[ac]->GetQueue ();
+  ParkedFrame &parked = m_parked[ac];
+  if (parked.packet != 0)
+    {
+      m_currentPacket = parked.packet;
+      m_currentHdr = parked.hdr;
+      m_aggregate.swap (parked.aggregate);
+      m_currentAmpdu = parked.ampdu;
+      m_fragmentNumber = parked.fragmentNumber;
+      m_resendRtsNum = parked.resendRtsNum;
+      m_resendDataNum = parked.resendDataNum;
+      parked.packet = 0;
+      parked.aggregate.clear ();
+      return;
+    }
+  m_currentPacket = m_queue->Dequeue (&m_currentHdr);
+  NS_ASSERT (m_currentPacket != 0);
+  std::list<ParkedFrame> &requeued = m_requeued[ac];
+  for (std::list<ParkedFrame>::iterator it = requeued.begin (); it != requeued.end (); it++)
+    {
+      if (it->packet == m_currentPacket)
+        {
+          m_currentHdr = it->hdr;
+          m_aggregate.swap (it->aggregate);
+          m_currentAmpdu = it->ampdu;
+          m_fragmentNumber = it->fragmentNumber;
+          m_resendRtsNum = it->resendRtsNum;
+          m_resendDataNum = it->resendDataNum;
+          requeued.erase (it);
+          return;
+        }
+    }
+  AssignSequenceNumber (&m_currentHdr);
+  m_aggregate.clear ();
+  m_currentAmpdu = false;
+  m_fragmentNumber = 0;
+  m_resendRtsNum = 0;
+  m_resendDataNum = 0;
+}
+
+bool
+CsmacaMac::IsRequeued (Ptr<const Packet> packet) const
+{
+  const std::list<ParkedFrame> &requeued = m_requeued[m_currentAc];
+  for (std::list<ParkedFrame>::const_iterator it = requeued.begin (); it != requeued.end (); it++)
+    {
+      if (it->packet == packet)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+CsmacaMac::RefillSaturationSource ()
+{
+  if (!m_saturation)
+    {
+      return;
+    }
+  if (m_saturationDestination.IsGroup ())
+    {
+      NS_FATAL_ERROR ("SaturationDestination must be a unicast address in saturation mode");
+    }
+  // Keep as many frames queued as an A-MPDU can carry, so that the
+  // saturated station aggregates and bursts as a loaded one would
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_DATA);
+  hdr.SetAddr1 (m_saturationDestination);
+  hdr.SetAddr2 (GetAddress ());
+  LlcSnapHeader llc;
+  CsmacaMacTrailer fcs;
+  uint32_t mpduSize = m_saturationPacketSize + llc.GetSerializedSize () + hdr.GetSize () + fcs.GetSize ();
+  uint32_t depth = 1;
+  if (m_maxAmpduSize > 0)
+    {
+      uint32_t ampduSize = CsmacaMpduAggregator::GetSizeIfAggregated (mpduSize, 0);
+      while (depth < CSMACA_BLOCK_ACK_WINDOW_SIZE
+             && CsmacaMpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize) <= m_maxAmpduSize)
+        {
+          ampduSize = CsmacaMpduAggregator::GetSizeIfAggregated (mpduSize, ampduSize);
+          depth++;
+        }
+    }
+  Ptr<CsmacaMacQueue> queue = m_acs[m_saturationAc]->GetQueue ();
+  while (queue->GetSize () < depth)
+    {
+      // The LLC/SNAP header lets the receiving device strip the frame as
+      // usual and hand it to a CsmacaTrafficSink, which listens on the
+      // local experimental ethertype by default
+      Ptr<Packet> packet = Create<Packet> (m_saturationPacketSize);
+      CSMACA_COUNT (MAC_ALLOCATIONS);
+      llc.SetType (0x88b5);
+      packet->AddHeader (llc);
+      if (!queue->Enqueue (packet, hdr))
+        {
+          break;
+        }
+    }
 }
 
 void
 CsmacaMac::StartBackoffIfNeeded ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
+  RefillSaturationSource ();
+  if (m_device != 0)
+    {
+      // Frames also leave the queues by expiring, without any dequeue
+      for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+        {
+          m_device->NotifyQueueDequeued (static_cast<enum CsmacaAcIndex> (i));
+        }
+    }
   if (m_currentPacket == 0 &&
-      !m_queue->IsEmpty () &&
-      m_backoffGrantStartEvent.IsExpired ())
+      HasPendingFrames () &&
+      m_backoffGrantStartEvent.IsExpired () &&
+      m_backoffTimeoutEvent.IsExpired ())
     {
-      m_currentPacket = m_queue->Dequeue (&m_currentHdr);
       BackoffGrantStart ();
     }
 }
@@ -550,7 +1651,7 @@ CsmacaMac::StartBackoffIfNeeded ()
 void
 CsmacaMac::BackoffGrantStart ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   Time backoffGrantStart = GetBackoffGrantStart ();
   if (backoffGrantStart <= Simulator::Now ())
     {
@@ -559,6 +1660,7 @@ CsmacaMac::BackoffGrantStart ()
   else
     {
       Time duration = backoffGrantStart - Simulator::Now ();
+      CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
       m_backoffGrantStartEvent = Simulator::Schedule (duration, &CsmacaMac::BackoffGrantStart, this);
     }
 }
@@ -566,28 +1668,139 @@ CsmacaMac::BackoffGrantStart ()
 void
 CsmacaMac::StartBackoff ()
 {
-  NS_LOG_FUNCTION (this);
-  m_backoffSlots = m_rng->GetNext (0, m_cw);
-  m_backoffStart = Simulator::Now ();
-  Time duration = m_backoffSlots * m_slotTime;
-  NS_LOG_DEBUG ("slot: "   << m_backoffSlots <<
-		", start: "<< m_backoffStart <<
-		", end: "  << m_backoffSlots * m_slotTime + m_backoffStart);
-  m_backoffTimeoutEvent = Simulator::Schedule (duration, &CsmacaMac::BackoffTimeout, this);
+  CSMACA_LOG_FUNCTION (this);
+  // Every access category with a frame draws its own backoff
+  Time earliest = Time::Max ();
+  for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+    {
+      enum CsmacaAcIndex ac = CSMACA_ACS_BY_PRIORITY[i];
+      if (HasPendingFrames (ac))
+        {
+          earliest = Min (earliest, DrawBackoff (ac));
+        }
+    }
+  CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+  m_backoffTimeoutEvent = Simulator::Schedule (earliest - Simulator::Now (), &CsmacaMac::BackoffTimeout, this);
+}
+
+Time
+CsmacaMac::DrawBackoff (enum CsmacaAcIndex ac)
+{
+  // The backoff counts from the end of the AIFS of the access category
+  Time start = Max (Simulator::Now (), GetBackoffGrantStart () - m_difs + GetAifs (ac));
+  uint32_t backoffSlots = m_rng->GetNext (0, m_acs[ac]->GetCw ());
+  Time end = start + backoffSlots * m_slotTime;
+  m_acs[ac]->SetBackoffEnd (end);
+  CSMACA_LOG_DEBUG ("ac: "     << ac <<
+		", slot: "  << backoffSlots <<
+		", start: " << start <<
+		", end: "   << end);
+  return end;
+}
+
+Time
+CsmacaMac::GetAifs (enum CsmacaAcIndex ac) const
+{
+  return m_sifs + m_acs[ac]->GetAifsn () * m_slotTime;
+}
+
+Time
+CsmacaMac::GetSifs (void) const
+{
+  return m_sifs;
+}
+
+Time
+CsmacaMac::GetDifs (void) const
+{
+  return m_difs;
+}
+
+Time
+CsmacaMac::GetSlotTime (void) const
+{
+  return m_slotTime;
+}
+
+Time
+CsmacaMac::GetMaxPropagationDelay (void) const
+{
+  return m_maxPropagationDelay;
+}
+
+uint32_t
+CsmacaMac::GetRate (void) const
+{
+  return m_rate;
+}
+
+uint32_t
+CsmacaMac::GetRtsThreshold (void) const
+{
+  return m_rtsSendThreshold;
 }
 
 void
 CsmacaMac::BackoffTimeout ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   Time sendGrantStartTime = GetSendGrantStart ();
   Time backoffGrantStart = GetBackoffGrantStart ();
   if (sendGrantStartTime <= Simulator::Now ())
     {
+      // The highest priority access category whose backoff ends now wins
+      // the medium; the other ones suffer an internal collision
+      bool won = false;
+      enum CsmacaAcIndex winner = CSMACA_AC_BE;
+      for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+        {
+          enum CsmacaAcIndex ac = CSMACA_ACS_BY_PRIORITY[i];
+          if (!HasPendingFrames (ac) || m_acs[ac]->GetBackoffEnd () > Simulator::Now ())
+            {
+              continue;
+            }
+          if (!won)
+            {
+              winner = ac;
+              won = true;
+            }
+          else
+            {
+              CSMACA_LOG_DEBUG ("internal collision, ac=" << ac);
+              m_acs[ac]->NotifyFailure ();
+            }
+        }
+      if (!won)
+        {
+          // The frames whose backoff ended now have expired in the queue
+          Time earliest = Time::Max ();
+          for (uint32_t i = 0; i < CSMACA_AC_N; i++)
+            {
+              enum CsmacaAcIndex ac = static_cast<enum CsmacaAcIndex> (i);
+              if (HasPendingFrames (ac))
+                {
+                  earliest = Min (earliest, m_acs[ac]->GetBackoffEnd ());
+                }
+            }
+          if (earliest != Time::Max ())
+            {
+              CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
+              m_backoffTimeoutEvent = Simulator::Schedule (earliest - Simulator::Now (),
+                                                           &CsmacaMac::BackoffTimeout, this);
+            }
+          return;
+        }
+      LoadCurrentPacket (winner);
+      NotifyQueueDequeued ();
+      m_txopStart = Simulator::Now ();
+      m_txopLimit = m_acs[winner]->GetTxopLimit ();
       // Need RTS/CTS + ACK
       if (!m_currentHdr.GetAddr1 ().IsGroup ())
 	{
-	  if (m_rtsSendThreshold <= m_currentPacket->GetSize ())
+	  AggregateCurrentPacket (true);
+	  uint32_t size = m_currentAmpdu ? GetCurrentPsduSize () : m_currentPacket->GetSize ();
+	  m_currentRts = NeedRts (m_currentHdr.GetAddr1 (), size);
+	  if (m_currentRts)
 	    {
 	      SendRts ();
 	    }
@@ -605,6 +1818,7 @@ CsmacaMac::BackoffTimeout ()
   else
     {
       Time duration = backoffGrantStart - Simulator::Now ();
+      CSMACA_COUNT (MAC_EVENTS_SCHEDULED);
       m_backoffGrantStartEvent = Simulator::Schedule (duration, &CsmacaMac::BackoffGrantStart, this);
     }
 }
@@ -612,15 +1826,25 @@ CsmacaMac::BackoffTimeout ()
 void
 CsmacaMac::CtsTimeout ()
 {
-  NS_LOG_FUNCTION (this << m_resendRtsNum);
+  CSMACA_LOG_FUNCTION (this << m_resendRtsNum);
+  NotifyRtsOutcome (false);
   if (m_resendRtsMax > m_resendRtsNum)
     {
       m_resendRtsNum++;
+      m_txRetryTrace (m_currentHdr, m_resendRtsNum);
+      for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::const_iterator i = m_aggregate.begin ();
+           i != m_aggregate.end (); i++)
+        {
+          m_txRetryTrace (i->second, m_resendRtsNum);
+        }
       UpdateCw ();
-      BackoffGrantStart ();
+      ParkCurrentPacket ();
+      StartBackoffIfNeeded ();
     }
   else
     {
+      NotifyCurrentPacketDiscarded ();
+      m_acs[m_currentAc]->NotifyDrop ();
       InitSend ();
       StartBackoffIfNeeded ();
     }
@@ -629,15 +1853,27 @@ CsmacaMac::CtsTimeout ()
 void
 CsmacaMac::AckTimeout ()
 {
-  NS_LOG_FUNCTION (this << m_resendDataNum);
+  CSMACA_LOG_FUNCTION (this << m_resendDataNum);
+  NotifyRtsOutcome (false);
   if (m_resendDataMax > m_resendDataNum)
     {
       m_resendDataNum++;
+      m_txRetryTrace (m_currentHdr, m_resendDataNum);
+      m_currentHdr.SetRetry ();
+      for (std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> >::iterator i = m_aggregate.begin ();
+           i != m_aggregate.end (); i++)
+        {
+          m_txRetryTrace (i->second, m_resendDataNum);
+          i->second.SetRetry ();
+        }
       UpdateCw ();
-      BackoffGrantStart ();
+      ParkCurrentPacket ();
+      StartBackoffIfNeeded ();
     }
   else
     {
+      NotifyCurrentPacketDiscarded ();
+      m_acs[m_currentAc]->NotifyDrop ();
       InitSend ();
       StartBackoffIfNeeded ();
     }
@@ -23,12 +23,20 @@
 
 #include <stdint.h>
 #include <string>
+#include <list>
+#include <map>
+#include <vector>
 #include "ns3/event-id.h"
 #include "ns3/traced-callback.h"
 #include "ns3/ptr.h"
 #include "csmaca-random-stream.h"
 #include "csmaca-preamble.h"
 #include "csmaca-mac-queue.h"
+#include "csmaca-mpdu-aggregator.h"
+#include "csmaca-ctrl-headers.h"
+#include "csmaca-block-ack-agreement.h"
+#include "csmaca-access-category.h"
+#include "csmaca-qos-utils.h"
 #include "csmaca-phy.h"
 #include "csmaca-phy-state-helper.h"
 #include "csmaca-net-device.h"
@@ -51,6 +59,7 @@ public:
 
   Ptr<CsmacaPhy> GetPhy ();
   Ptr<CsmacaMacQueue> GetQueue ();
+  Ptr<CsmacaAccessCategory> GetAccessCategory (enum CsmacaAcIndex ac) const;
   Mac48Address GetAddress ();
   void SetPhy (Ptr<CsmacaPhy> phy);
   void SetQueue (Ptr<CsmacaMacQueue> queue);
@@ -59,37 +68,131 @@ public:
 
   void ReceiveOk (Ptr<Packet> packet);
   void ReceiveError (Ptr<Packet> packet);
+  void ReceiveAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus, std::vector<bool> statusPerMpdu);
 
   void NotifyMaybeCcaBusyStartNow (Time duration);
   void NotifyTxStartNow (Time duration);
   void NotifyRxStartNow (Time duration);
   void SetupPhyCsmacaMacListener (Ptr<CsmacaPhyStateHelper> state);
-  void Enqueue (Ptr<Packet const> packet, const CsmacaMacHeader &hdr);
+  /**
+   * \return false if the queue of the access category dropped the packet
+   */
+  bool Enqueue (Ptr<Packet const> packet, const CsmacaMacHeader &hdr);
+  bool Enqueue (Ptr<Packet const> packet, const CsmacaMacHeader &hdr, enum CsmacaAcIndex ac);
 
   void StartBackoffIfNeeded ();
+  /**
+   * In saturation mode, queue synthesized frames until the queue of the
+   * saturated access category holds as many as an A-MPDU can carry, or
+   * one without aggregation.
+   */
+  void RefillSaturationSource ();
   void StartBackoff ();
+  Time DrawBackoff (enum CsmacaAcIndex ac);
+  Time GetAifs (enum CsmacaAcIndex ac) const;
+  Time GetSifs (void) const;
+  Time GetDifs (void) const;
+  Time GetSlotTime (void) const;
+  Time GetMaxPropagationDelay (void) const;
+  /**
+   * \return the rate of data frames in bytes per second
+   */
+  uint32_t GetRate (void) const;
+  uint32_t GetRtsThreshold (void) const;
+  bool HasPendingFrames (enum CsmacaAcIndex ac) const;
+  bool HasPendingFrames (void) const;
+  void ParkCurrentPacket ();
+  void LoadCurrentPacket (enum CsmacaAcIndex ac);
+  /**
+   * \return true if the packet went back to the queue of the current
+   *         access category after a failed attempt
+   */
+  bool IsRequeued (Ptr<const Packet> packet) const;
   Time GetBackoffGrantStart (void) const;
   Time GetSendGrantStart (void) const;
+  /**
+   * Report the idle slots which preceded the start of a transmission
+   * on the medium to the contention window policies
+   */
+  void NotifyMediumBusyStart (void);
 
+  /**
+   * Let the device wake its transmit queue once the queue of the
+   * current access category has drained below its low watermark
+   */
+  void NotifyQueueDequeued ();
   void UpdateCw ();
   void InitSend ();
   void SetNav (Time duration);
   Time CalculateDataSendTime (CsmacaPreamble preamble);
+  Time GetResponseSendAndSifsTime (void) const;
+  uint16_t GetNextSequenceNumberFor (Mac48Address dest);
+  void AssignSequenceNumber (CsmacaMacHeader *hdr);
+  bool NeedBlockAckReq (void) const;
+  bool IsDuplicate (const CsmacaMacHeader &hdr);
+  bool NeedFragmentation (void) const;
+  bool IsLastFragment (void) const;
+  uint32_t GetFragmentSize (uint32_t fragmentNumber) const;
+  Time CalculateFragmentSendTime (uint32_t fragmentNumber, CsmacaPreamble preamble) const;
+  Ptr<Packet> Reassemble (Ptr<Packet> packet, const CsmacaMacHeader &hdr);
+  Time GetTxopRemaining (void) const;
+  /**
+   * \param txDuration the duration of the data frame
+   * \param responseDuration the duration of its response and the SIFS before it
+   * \param rts whether the frame is protected by RTS/CTS
+   * \return true if the exchange, after a SIFS, ends inside the TXOP
+   */
+  bool FitsInTxop (Time txDuration, Time responseDuration, bool rts) const;
+  bool ContinueTxop ();
+  /**
+   * \return true if a frame of the given size to dest would be protected
+   *         by RTS/CTS, without consuming an adaptive RTS credit
+   */
+  bool WouldNeedRts (Mac48Address dest, uint32_t size) const;
+  bool NeedRts (Mac48Address dest, uint32_t size);
+  void NotifyRtsOutcome (bool success);
+  void NotifyCurrentPacketDiscarded ();
+  /**
+   * \param firstInTxop true if the aggregate opens the TXOP, in which case
+   *        it may be protected by RTS/CTS
+   */
+  void AggregateCurrentPacket (bool firstInTxop);
+  uint32_t GetCurrentPsduSize (void) const;
+  uint32_t GetCurrentAmpduSize (void) const;
+  Ptr<Packet> GetCurrentPsdu (Time duration, CsmacaPreamble *preamble);
 
   void SendRts ();
   void SendCtsAfterRts (Mac48Address source, Time duration);
   void SendDataNoAck ();
   void SendDataAfterCts ();
   void SendAckAfterData (Mac48Address source);
+  void SendBlockAckAfterAmpdu (Mac48Address source);
+  void ReceiveBlockAck (Mac48Address source, const CsmacaBlockAckHeader &blockAck);
+  void ForwardUp (const CsmacaRecipientBlockAckAgreement::Mpdus &mpdus);
 
   void BackoffGrantStart ();
   void BackoffTimeout ();
   void AckTimeout ();
   void CtsTimeout ();
 
+protected:
+  virtual void DoInitialize (void);
+  virtual void DoDispose (void);
+
 private:
+  Ptr<CsmacaAccessCategory> GetVOAccessCategory (void) const;
+  Ptr<CsmacaAccessCategory> GetVIAccessCategory (void) const;
+  Ptr<CsmacaAccessCategory> GetBEAccessCategory (void) const;
+  Ptr<CsmacaAccessCategory> GetBKAccessCategory (void) const;
+
   class PhyCsmacaMacListener *m_phyCsmacaMacListener;
   Ptr<CsmacaPhy> m_phy;
+  std::vector<Ptr<CsmacaAccessCategory> > m_acs;
+  /**
+   * The access category which won the medium for the current packet,
+   * and its queue.
+   */
+  enum CsmacaAcIndex m_currentAc;
   Ptr<CsmacaMacQueue> m_queue;
   Ptr<CsmacaNetDevice> m_device;
   CsmacaRandomStream *m_rng;
@@ -97,13 +200,110 @@ private:
   Mac48Address m_address;
   Ptr<Packet const> m_currentPacket;
   CsmacaMacHeader m_currentHdr;
+  /**
+   * MPDUs aggregated behind the current packet, all addressed to the
+   * same destination as the current packet.
+   */
+  std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> > m_aggregate;
+  uint32_t m_maxAmpduSize;
+  /**
+   * True if the current packet is sent as an aggregated frame, which
+   * the recipient answers with a BlockAck instead of an ACK.
+   */
+  bool m_currentAmpdu;
+  /**
+   * The frame of an access category which has to contend again for a
+   * retransmission, kept aside while other access categories may win
+   * the medium.
+   */
+  struct ParkedFrame
+  {
+    ParkedFrame ()
+      : ampdu (false),
+        fragmentNumber (0),
+        resendRtsNum (0),
+        resendDataNum (0)
+    {
+    }
+    Ptr<const Packet> packet;
+    CsmacaMacHeader hdr;
+    std::list<std::pair<Ptr<const Packet>, CsmacaMacHeader> > aggregate;
+    bool ampdu;
+    uint32_t fragmentNumber;
+    uint16_t resendRtsNum;
+    uint16_t resendDataNum;
+  };
+  std::vector<ParkedFrame> m_parked;
+  /**
+   * With a queue scheduled per destination the frame goes back to the
+   * front of its destination's queue instead, so that the scheduler
+   * may serve other destinations first; the rest of its state waits
+   * here until the queue gives the frame back.
+   */
+  std::vector<std::list<ParkedFrame> > m_requeued;
+
+  std::map<Mac48Address, uint16_t> m_txSequences;
+  std::map<Mac48Address, CsmacaOriginatorBlockAckAgreement> m_originatorAgreements;
+  std::map<Mac48Address, CsmacaRecipientBlockAckAgreement> m_recipientAgreements;
+  /**
+   * Sequence control of the last frame received from each source,
+   * used to drop retransmissions whose ACK was lost.
+   */
+  std::map<Mac48Address, uint16_t> m_rxSequences;
+
+  /**
+   * Once the medium is won, further queued frames of the same access
+   * category follow the previous ACK after SIFS until
+   * m_txopStart + m_txopLimit. 0 disables bursting.
+   */
+  Time m_txopLimit;
+  Time m_txopStart;
+
+  uint32_t m_fragmentationThreshold;
+  uint32_t m_fragmentNumber;
+  /**
+   * The MSDU being reassembled from one source. Only one MSDU per
+   * source is kept: its first fragment drops any unfinished one.
+   */
+  struct Reassembly
+  {
+    uint16_t seq;
+    uint8_t nextFragment;
+    Ptr<Packet> packet;
+  };
+  std::map<Mac48Address, Reassembly> m_reassembly;
+
+  /**
+   * Saturation mode: the MAC never runs out of frames of
+   * m_saturationAc, which are synthesized without any upper layer.
+   */
+  bool m_saturation;
+  uint32_t m_saturationPacketSize;
+  Mac48Address m_saturationDestination;
+  enum CsmacaAcIndex m_saturationAc;
 
   uint32_t m_rtsSendThreshold;
+  /**
+   * In adaptive mode RTS/CTS is switched on per destination once an
+   * unprotected frame is lost (A-RTS filter): the window grows by one
+   * on each such loss and is halved on each unprotected success, and
+   * the next window frames to the destination are protected.
+   */
+  struct RtsState
+  {
+    uint32_t window;
+    uint32_t counter;
+  };
+  std::map<Mac48Address, RtsState> m_rtsStates;
+  bool m_adaptiveRts;
+  uint32_t m_maxRtsWindow;
+  bool m_currentRts;
 
   Time m_maxPropagationDelay;
   Time m_rtsSendAndSifsTime;
   Time m_ctsSendAndSifsTime;
   Time m_ackSendAndSifsTime;
+  Time m_blockAckSendAndSifsTime;
   Time m_rtsNavDuration;
 
   uint16_t m_resendRtsNum;
@@ -111,14 +311,9 @@ private:
   uint16_t m_resendDataNum;
   uint16_t m_resendDataMax;
 
-  uint32_t m_cwMin;
-  uint32_t m_cwMax;
-  uint32_t m_cw;
-  uint32_t m_backoffSlots;
   Time m_sifs;
   Time m_difs;
   Time m_slotTime;
-  Time m_backoffStart;
 
   Time m_lastRxStart;
   Time m_lastRxDuration;
@@ -142,6 +337,10 @@ private:
   EventId m_backoffTimeoutEvent;
   EventId m_backoffGrantStartEvent;
 
+  TracedCallback<Ptr<const Packet>, const CsmacaMacHeader &> m_txOkTrace;
+  TracedCallback<const CsmacaMacHeader &, uint32_t> m_txRetryTrace;
+  TracedCallback<Ptr<const Packet>, const CsmacaMacHeader &> m_txDropTrace;
+
 
 };
 
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "csmaca-mpdu-aggregator.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaMpduAggregator");
+
+namespace ns3 {
+
+void
+CsmacaMpduAggregator::Aggregate (Ptr<const Packet> mpdu, Ptr<Packet> ampdu)
+{
+  CSMACA_LOG_FUNCTION (mpdu << ampdu);
+  uint32_t padding = CalculatePadding (ampdu->GetSize ());
+  if (padding > 0)
+    {
+      ampdu->AddPaddingAtEnd (padding);
+    }
+
+  CsmacaAmpduSubframeHeader delimiter;
+  delimiter.SetLength (mpdu->GetSize ());
+
+  Ptr<Packet> subframe = mpdu->Copy ();
+  subframe->AddHeader (delimiter);
+  ampdu->AddAtEnd (subframe);
+}
+
+uint32_t
+CsmacaMpduAggregator::GetSizeIfAggregated (uint32_t mpduSize, uint32_t ampduSize)
+{
+  return ampduSize + CalculatePadding (ampduSize) + CSMACA_AMPDU_DELIMITER_LENGTH + mpduSize;
+}
+
+CsmacaMpduAggregator::DeaggregatedMpdus
+CsmacaMpduAggregator::Deaggregate (Ptr<Packet> aggregatedPacket)
+{
+  CSMACA_LOG_FUNCTION (aggregatedPacket);
+  DeaggregatedMpdus set;
+
+  Ptr<Packet> packet = aggregatedPacket->Copy ();
+  while (packet->GetSize () >= CSMACA_AMPDU_DELIMITER_LENGTH)
+    {
+      CsmacaAmpduSubframeHeader delimiter;
+      packet->RemoveHeader (delimiter);
+      if (!delimiter.IsValid () || delimiter.GetLength () > packet->GetSize ())
+        {
+          CSMACA_LOG_DEBUG ("invalid delimiter: " << delimiter);
+          break;
+        }
+      Ptr<Packet> mpdu = packet->CreateFragment (0, delimiter.GetLength ());
+      set.push_back (std::make_pair (mpdu, delimiter));
+
+      uint32_t consumed = CSMACA_AMPDU_DELIMITER_LENGTH + delimiter.GetLength ();
+      uint32_t skip = std::min (delimiter.GetLength () + CalculatePadding (consumed),
+                                packet->GetSize ());
+      packet->RemoveAtStart (skip);
+    }
+  return set;
+}
+
+uint32_t
+CsmacaMpduAggregator::CalculatePadding (uint32_t ampduSize)
+{
+  return (4 - (ampduSize % 4)) % 4;
+}
+
+} // namespace ns3
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_MPDU_AGGREGATOR_H
+#define CSMACA_MPDU_AGGREGATOR_H
+
+#include <stdint.h>
+#include <list>
+#include <utility>
+#include "ns3/packet.h"
+#include "csmaca-ampdu-subframe-header.h"
+
+namespace ns3 {
+
+/**
+ * Builds and splits aggregated frames.
+ *
+ * An aggregated frame is a sequence of subframes
+ * |Delimiter|MPDU|Padding| where the padding aligns every subframe
+ * but the last one on a 4 octet boundary.
+ */
+class CsmacaMpduAggregator
+{
+public:
+  /**
+   * A list of deaggregated MPDUs and their delimiters, in the order
+   * in which they appear in the aggregated frame.
+   */
+  typedef std::list<std::pair<Ptr<Packet>, CsmacaAmpduSubframeHeader> > DeaggregatedMpdus;
+  typedef std::list<std::pair<Ptr<Packet>, CsmacaAmpduSubframeHeader> >::const_iterator DeaggregatedMpdusCI;
+
+  /**
+   * Append the given MPDU, preceded by its delimiter, to the aggregated frame.
+   *
+   * \param mpdu the MPDU (header, payload and FCS)
+   * \param ampdu the aggregated frame
+   */
+  static void Aggregate (Ptr<const Packet> mpdu, Ptr<Packet> ampdu);
+  /**
+   * \param mpduSize the size of the MPDU to append
+   * \param ampduSize the current size of the aggregated frame
+   * \return the size of the aggregated frame once the MPDU is appended
+   */
+  static uint32_t GetSizeIfAggregated (uint32_t mpduSize, uint32_t ampduSize);
+  /**
+   * Split an aggregated frame into its MPDUs. Parsing stops at the
+   * first delimiter whose signature or CRC is wrong.
+   *
+   * \param aggregatedPacket the aggregated frame
+   * \return the MPDUs found in the frame
+   */
+  static DeaggregatedMpdus Deaggregate (Ptr<Packet> aggregatedPacket);
+
+private:
+  static uint32_t CalculatePadding (uint32_t ampduSize);
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_MPDU_AGGREGATOR_H */
@@ -22,9 +22,12 @@
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/llc-snap-header.h"
 #include "csmaca-net-device.h"
+#include "csmaca-qos-utils.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaNetDevice");
 
@@ -41,6 +44,37 @@ CsmacaNetDevice::GetTypeId (void)
     .AddTraceSource ("PhyRxDrop",
                      "Trace source indicating a packet has been dropped by the device during reception",
                      MakeTraceSourceAccessor (&CsmacaNetDevice::m_phyRxDropTrace))
+    .AddAttribute ("HighWatermark",
+                   "Number of packets in the MAC queue of an access category at which Send "
+                   "stops accepting packets of that category. 0 disables the limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaNetDevice::m_highWatermark),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LowWatermark",
+                   "Number of packets in the MAC queue at which a stopped access category wakes.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaNetDevice::m_lowWatermark),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BytesHighWatermark",
+                   "Number of bytes in the MAC queue of an access category at which Send "
+                   "stops accepting packets of that category. 0 disables the limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaNetDevice::m_bytesHighWatermark),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BytesLowWatermark",
+                   "Number of bytes in the MAC queue at which a stopped access category wakes.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaNetDevice::m_bytesLowWatermark),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("MacTxDrop",
+                     "Trace source indicating a packet has been refused by Send",
+                     MakeTraceSourceAccessor (&CsmacaNetDevice::m_macTxDropTrace))
+    .AddTraceSource ("TxQueueStop",
+                     "The transmit queue of the given access category has been stopped",
+                     MakeTraceSourceAccessor (&CsmacaNetDevice::m_txQueueStopTrace))
+    .AddTraceSource ("TxQueueWake",
+                     "The transmit queue of the given access category has been woken",
+                     MakeTraceSourceAccessor (&CsmacaNetDevice::m_txQueueWakeTrace))
   ;
   return tid;
 }
@@ -48,12 +82,14 @@ CsmacaNetDevice::GetTypeId (void)
 CsmacaNetDevice::CsmacaNetDevice ()
   : m_node (0),
     m_mtu (0xffff),
-    m_ifIndex (0)
+    m_ifIndex (0),
+    m_highWatermark (0),
+    m_lowWatermark (0),
+    m_bytesHighWatermark (0),
+    m_bytesLowWatermark (0),
+    m_txQueueStopped (CSMACA_AC_N, false)
 {
-  NS_LOG_FUNCTION (this);
-  SetMac (CreateObject<CsmacaMac>());
-  GetMac ()->SetNetDevice (this);
-  SetPhy (GetMac()->GetPhy());
+  CSMACA_LOG_FUNCTION (this);
 }
 void
 CsmacaNetDevice::SetPhy (Ptr<CsmacaPhy> phy)
@@ -68,22 +104,32 @@ CsmacaNetDevice::SetMac (Ptr<CsmacaMac> mac)
 Ptr<CsmacaPhy>
 CsmacaNetDevice::GetPhy ()
 {
+  if (m_phy == 0)
+    {
+      m_phy = GetMac ()->GetPhy ();
+    }
   return m_phy;
 }
 Ptr<CsmacaMac>
 CsmacaNetDevice::GetMac ()
 {
+  if (m_mac == 0)
+    {
+      // Only built when nothing, e.g. a helper, supplied a MAC
+      m_mac = CreateObject<CsmacaMac> ();
+      m_mac->SetNetDevice (this);
+    }
   return m_mac;
 }
 
 void
 CsmacaNetDevice::Receive (Ptr<Packet> packet, Mac48Address to, Mac48Address from)
 {
-  NS_LOG_FUNCTION (this << packet << to << from);
+  CSMACA_LOG_FUNCTION (this << packet << to << from);
   NetDevice::PacketType packetType;
   LlcSnapHeader llc;
   packet->RemoveHeader (llc);
-  NS_LOG_DEBUG (llc.GetType ());
+  CSMACA_LOG_DEBUG (llc.GetType ());
   
   if (to == m_address)
     {
@@ -101,36 +147,85 @@ CsmacaNetDevice::Receive (Ptr<Packet> packet, Mac48Address to, Mac48Address from
     {
       packetType = NetDevice::PACKET_OTHERHOST;
     }
-  m_rxCallback (this, packet, llc.GetType (), from);
+  // Frames for other hosts, overheard or relayed through this device,
+  // only reach the promiscuous callback
+  if (packetType != NetDevice::PACKET_OTHERHOST)
+    {
+      m_rxCallback (this, packet, llc.GetType (), from);
+    }
   if (!m_promiscCallback.IsNull ())
     {
       m_promiscCallback (this, packet, llc.GetType (), from, to, packetType);
     }
 }
 
+void
+CsmacaNetDevice::CheckTxQueueStop (enum CsmacaAcIndex ac)
+{
+  Ptr<CsmacaMacQueue> queue = m_mac->GetAccessCategory (ac)->GetQueue ();
+  if (!m_txQueueStopped[ac]
+      && ((m_highWatermark > 0 && queue->GetSize () >= m_highWatermark)
+          || (m_bytesHighWatermark > 0 && queue->GetNBytes () >= m_bytesHighWatermark)))
+    {
+      CSMACA_LOG_DEBUG ("stop ac=" << ac << ", size=" << queue->GetSize ());
+      m_txQueueStopped[ac] = true;
+      m_txQueueStopTrace (ac);
+    }
+}
+
+void
+CsmacaNetDevice::NotifyQueueDequeued (enum CsmacaAcIndex ac)
+{
+  if (!m_txQueueStopped[ac])
+    {
+      return;
+    }
+  Ptr<CsmacaMacQueue> queue = m_mac->GetAccessCategory (ac)->GetQueue ();
+  // IsEmpty first drops the expired frames, which leave the queue
+  // without any dequeue
+  queue->IsEmpty ();
+  if ((m_highWatermark == 0 || queue->GetSize () <= m_lowWatermark)
+      && (m_bytesHighWatermark == 0 || queue->GetNBytes () <= m_bytesLowWatermark))
+    {
+      CSMACA_LOG_DEBUG ("wake ac=" << ac << ", size=" << queue->GetSize ());
+      m_txQueueStopped[ac] = false;
+      m_txQueueWakeTrace (ac);
+    }
+}
+
+bool
+CsmacaNetDevice::IsTxQueueStopped (enum CsmacaAcIndex ac) const
+{
+  return m_txQueueStopped[ac];
+}
+
 void 
 CsmacaNetDevice::SetIfIndex (const uint32_t index)
 {
-  NS_LOG_FUNCTION (this << index);
+  CSMACA_LOG_FUNCTION (this << index);
   m_ifIndex = index;
 }
 uint32_t 
 CsmacaNetDevice::GetIfIndex (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return m_ifIndex;
 }
 Ptr<Channel>
 CsmacaNetDevice::GetChannel (void) const
 {
+  if (m_phy == 0)
+    {
+      return 0;
+    }
   return m_phy->GetChannel ();
 }
 void
 CsmacaNetDevice::SetAddress (Address address)
 {
-  NS_LOG_FUNCTION (this << address);
+  CSMACA_LOG_FUNCTION (this << address);
   m_address = Mac48Address::ConvertFrom (address);
-  m_mac->SetAddress (m_address);
+  GetMac ()->SetAddress (m_address);
 }
 Address 
 CsmacaNetDevice::GetAddress (void) const
@@ -138,82 +233,96 @@ CsmacaNetDevice::GetAddress (void) const
   //
   // Implicit conversion from Mac48Address to Address
   //
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return m_address;
 }
 bool 
 CsmacaNetDevice::SetMtu (const uint16_t mtu)
 {
-  NS_LOG_FUNCTION (this << mtu);
+  CSMACA_LOG_FUNCTION (this << mtu);
   m_mtu = mtu;
   return true;
 }
 uint16_t 
 CsmacaNetDevice::GetMtu (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return m_mtu;
 }
 bool 
 CsmacaNetDevice::IsLinkUp (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return true;
 }
 void 
 CsmacaNetDevice::AddLinkChangeCallback (Callback<void> callback)
 {
- NS_LOG_FUNCTION (this << &callback);
+ CSMACA_LOG_FUNCTION (this << &callback);
 }
 bool 
 CsmacaNetDevice::IsBroadcast (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return true;
 }
 Address
 CsmacaNetDevice::GetBroadcast (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return Mac48Address ("ff:ff:ff:ff:ff:ff");
 }
 bool 
 CsmacaNetDevice::IsMulticast (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return false;
 }
 Address 
 CsmacaNetDevice::GetMulticast (Ipv4Address multicastGroup) const
 {
-  NS_LOG_FUNCTION (this << multicastGroup);
+  CSMACA_LOG_FUNCTION (this << multicastGroup);
   return Mac48Address::GetMulticast (multicastGroup);
 }
 
 Address CsmacaNetDevice::GetMulticast (Ipv6Address addr) const
 {
-  NS_LOG_FUNCTION (this << addr);
+  CSMACA_LOG_FUNCTION (this << addr);
   return Mac48Address::GetMulticast (addr);
 }
 
 bool 
 CsmacaNetDevice::IsPointToPoint (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return false;
 }
 
 bool 
 CsmacaNetDevice::IsBridge (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return false;
 }
 
 bool 
 CsmacaNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber)
 {
-  NS_LOG_FUNCTION (this << packet << dest << protocolNumber);
+  CSMACA_LOG_FUNCTION (this << packet << dest << protocolNumber);
+  return SendFrom (packet, GetMac ()->GetAddress (), dest, protocolNumber);
+}
+bool 
+CsmacaNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber)
+{
+  CSMACA_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
+
+  enum CsmacaAcIndex ac = CsmacaQosUtilsMapTidToAc (CsmacaQosUtilsGetTidForPacket (packet, protocolNumber));
+  NotifyQueueDequeued (ac);
+  if (m_txQueueStopped[ac])
+    {
+      m_macTxDropTrace (packet);
+      return false;
+    }
 
   LlcSnapHeader llc;
   llc.SetType (protocolNumber);
@@ -224,50 +333,72 @@ CsmacaNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
   hdr.SetType (CSMACA_MAC_DATA);
   hdr.SetAddr1 (to);
   hdr.SetAddr2 (m_mac->GetAddress ());
-  m_mac->Enqueue (packet, hdr);
-  return true;
-}
-bool 
-CsmacaNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber)
-{
-  NS_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
-  //  Mac48Address to = Mac48Address::ConvertFrom (dest);
-  //  Mac48Address from = Mac48Address::ConvertFrom (source);
-  //  m_mac->Send (packet, protocolNumber, to, from);
+  Mac48Address from = Mac48Address::ConvertFrom (source);
+  if (from != m_mac->GetAddress ())
+    {
+      // Keep the original source for the receiver
+      hdr.SetFourAddress ();
+      hdr.SetAddr3 (to);
+      hdr.SetAddr4 (from);
+    }
+  if (!m_mac->Enqueue (packet, hdr, ac))
+    {
+      m_macTxDropTrace (packet);
+      return false;
+    }
+  CheckTxQueueStop (ac);
   return true;
 }
 
 Ptr<Node> 
 CsmacaNetDevice::GetNode (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return m_node;
 }
 void 
 CsmacaNetDevice::SetNode (Ptr<Node> node)
 {
-  NS_LOG_FUNCTION (this << node);
+  CSMACA_LOG_FUNCTION (this << node);
   m_node = node;
 }
 bool 
 CsmacaNetDevice::NeedsArp (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return true;
 }
 void 
 CsmacaNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
 {
-  NS_LOG_FUNCTION (this << &cb);
+  CSMACA_LOG_FUNCTION (this << &cb);
   m_rxCallback = cb;
 }
 
+void
+CsmacaNetDevice::DoInitialize (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  GetPhy ();
+  m_mac->Initialize ();
+  NetDevice::DoInitialize ();
+}
+
 void
 CsmacaNetDevice::DoDispose (void)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   m_node = 0;
+  if (m_mac != 0)
+    {
+      m_mac->Dispose ();
+    }
+  if (m_phy != 0)
+    {
+      m_phy->Dispose ();
+    }
   m_mac = 0;
+  m_phy = 0;
   NetDevice::DoDispose ();
 }
 
@@ -275,14 +406,14 @@ CsmacaNetDevice::DoDispose (void)
 void
 CsmacaNetDevice::SetPromiscReceiveCallback (PromiscReceiveCallback cb)
 {
-  NS_LOG_FUNCTION (this << &cb);
+  CSMACA_LOG_FUNCTION (this << &cb);
   m_promiscCallback = cb;
 }
 
 bool
 CsmacaNetDevice::SupportsSendFrom (void) const
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   return true;
 }
 
@@ -22,11 +22,13 @@
 
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "ns3/net-device.h"
 #include "ns3/mac48-address.h"
 #include "ns3/traced-callback.h"
 #include "csmaca-mac.h"
 #include "csmaca-phy.h"
+#include "csmaca-qos-utils.h"
 
 namespace ns3 {
 
@@ -55,11 +57,28 @@ public:
   CsmacaNetDevice ();
   void SetPhy (Ptr<CsmacaPhy> phy);
   void SetMac (Ptr<CsmacaMac> mac);
+  /**
+   * The MAC and PHY are only built here, on first use, when none was set.
+   */
   Ptr<CsmacaPhy> GetPhy ();
   Ptr<CsmacaMac> GetMac ();
 
   void Receive (Ptr<Packet> packet, Mac48Address to, Mac48Address from);
-  
+  /**
+   * Called by the MAC after frames may have left the queue of an access
+   * category, dequeued or expired, and by Send before refusing a packet.
+   * Wakes the transmit queue of the access category once it is at or
+   * below both low watermarks.
+   *
+   * \param ac the access category
+   */
+  void NotifyQueueDequeued (enum CsmacaAcIndex ac);
+  /**
+   * \param ac the access category
+   * \return true if Send refuses packets of the access category until
+   *         its MAC queue has drained
+   */
+  bool IsTxQueueStopped (enum CsmacaAcIndex ac) const;
 
   // inherited from NetDevice base class.
   virtual void SetIfIndex (const uint32_t index);
@@ -90,8 +109,15 @@ public:
   virtual bool SupportsSendFrom (void) const;
 
 protected:
+  virtual void DoInitialize (void);
   virtual void DoDispose (void);
 private:
+  /**
+   * Stop the transmit queue of the access category if its MAC queue
+   * has reached one of the high watermarks.
+   */
+  void CheckTxQueueStop (enum CsmacaAcIndex ac);
+
   NetDevice::ReceiveCallback m_rxCallback; //!< Receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
   Ptr<Node> m_node; //!< Node this netDevice is associated to
@@ -101,7 +127,16 @@ private:
   uint32_t m_ifIndex; //!< Interface index
   Mac48Address m_address; //!< MAC address
 
+  uint32_t m_highWatermark; //!< Packets at which the transmit queue stops, 0 to disable
+  uint32_t m_lowWatermark; //!< Packets at which the transmit queue wakes
+  uint32_t m_bytesHighWatermark; //!< Bytes at which the transmit queue stops, 0 to disable
+  uint32_t m_bytesLowWatermark; //!< Bytes at which the transmit queue wakes
+  std::vector<bool> m_txQueueStopped; //!< Per access category
+
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
+  TracedCallback<Ptr<const Packet> > m_macTxDropTrace;
+  TracedCallback<uint32_t> m_txQueueStopTrace;
+  TracedCallback<uint32_t> m_txQueueWakeTrace;
 };
 
 } // namespace ns3
@@ -18,8 +18,10 @@
  * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
  */
 
+#include <algorithm>
 #include "csmaca-phy-state-helper.h"
 #include "ns3/log.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaPhyStateHelper");
 
@@ -41,7 +43,7 @@ CsmacaPhyStateHelper::CsmacaPhyStateHelper ()
     m_listeners (0),
     m_rxing (false)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 }
 
 void
@@ -137,16 +139,38 @@ CsmacaPhyStateHelper::EndReceiveError (Ptr<Packet> packet)
   m_rxing = false;
 }
 
+void
+CsmacaPhyStateHelper::EndReceiveAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus,
+                                       std::vector<bool> statusPerMpdu)
+{
+  for (Listeners::const_iterator i = m_listeners.begin (); i != m_listeners.end (); i++)
+    {
+      (*i)->NotifyRxEndAmpdu (mpdus, statusPerMpdu);
+    }
+
+  m_rxing = false;
+}
+
 void
 CsmacaPhyStateHelper::RegisterListener (CsmacaPhyListener *listener)
 {
   m_listeners.push_back (listener);
 }
 
+void
+CsmacaPhyStateHelper::UnregisterListener (CsmacaPhyListener *listener)
+{
+  Listeners::iterator i = std::find (m_listeners.begin (), m_listeners.end (), listener);
+  if (i != m_listeners.end ())
+    {
+      m_listeners.erase (i);
+    }
+}
+
 void
 CsmacaPhyStateHelper::SwitchMaybeToCcaBusy (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
+  CSMACA_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
   NotifyMaybeCcaBusyStart (duration);
   Time now = Simulator::Now ();
 
@@ -160,7 +184,7 @@ CsmacaPhyStateHelper::SwitchMaybeToCcaBusy (Time duration)
 void
 CsmacaPhyStateHelper::SwitchToTx (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
+  CSMACA_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
   NotifyTxStart (duration);
   Time now = Simulator::Now ();
   switch (GetState ())
@@ -186,7 +210,7 @@ CsmacaPhyStateHelper::SwitchToTx (Time duration)
 void
 CsmacaPhyStateHelper::SwitchToRx (Time duration)
 {
-  NS_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
+  CSMACA_LOG_FUNCTION (this << duration << duration + Simulator::Now ());
   NS_ASSERT (IsStateIdle () || IsStateCcaBusy ());
   NS_ASSERT (!m_rxing);
   NotifyRxStart (duration);
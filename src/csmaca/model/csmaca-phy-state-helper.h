@@ -24,11 +24,13 @@
 #include "csmaca-phy-state.h"
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "ns3/csmaca-phy.h"
 #include "ns3/traced-callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/simulator.h"
+#include "csmaca-mpdu-aggregator.h"
 
 namespace ns3 {
 class CsmacaPhyListener
@@ -37,6 +39,12 @@ public:
   virtual ~CsmacaPhyListener ();
   virtual void NotifyRxEndOk (Ptr<Packet> packet) = 0;
   virtual void NotifyRxEndError (Ptr<Packet> packet) = 0;
+  /**
+   * \param mpdus the MPDUs of the received aggregated frame
+   * \param statusPerMpdu true for every MPDU received without error
+   */
+  virtual void NotifyRxEndAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus,
+                                 std::vector<bool> statusPerMpdu) = 0;
   virtual void NotifyMaybeCcaBusyStart (Time duration) = 0;
   virtual void NotifyTxStart (Time duration) = 0;
   virtual void NotifyRxStart (Time duration) = 0;
@@ -65,7 +73,10 @@ public:
 
   void EndReceiveOk (Ptr<Packet> packet);
   void EndReceiveError (Ptr<Packet> packet);
+  void EndReceiveAmpdu (CsmacaMpduAggregator::DeaggregatedMpdus mpdus,
+                        std::vector<bool> statusPerMpdu);
   void RegisterListener (CsmacaPhyListener *listener);
+  void UnregisterListener (CsmacaPhyListener *listener);
 
 private:
   typedef std::vector<CsmacaPhyListener *> Listeners;
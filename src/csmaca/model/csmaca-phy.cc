@@ -30,6 +30,8 @@
 
 #include "csmaca-phy.h"
 #include "csmaca-preamble.h"
+#include "csmaca-counters.h"
+#include "csmaca-log.h"
 
 NS_LOG_COMPONENT_DEFINE ("CsmacaPhy");
 
@@ -45,8 +47,7 @@ CsmacaPhy::CsmacaPhy ()
     m_txPowerDbm (20),
     m_endRxEvent ()
 {
-  NS_LOG_FUNCTION (this);
-  m_channel = CreateObject<CsmacaChannel>();
+  CSMACA_LOG_FUNCTION (this);
   m_state = CreateObject<CsmacaPhyStateHelper>();
   m_random = CreateObject<UniformRandomVariable> ();
 
@@ -56,7 +57,7 @@ CsmacaPhy::CsmacaPhy ()
 }
 CsmacaPhy::~CsmacaPhy ()
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
 }
 void
 CsmacaPhy::DoDispose (){
@@ -69,6 +70,7 @@ CsmacaPhy::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::CsmacaPhy")
     .SetParent<Object> ()
+    .AddConstructor<CsmacaPhy> ()
     .AddTraceSource ("StartTx", "Start transmission",
                      MakeTraceSourceAccessor (&CsmacaPhy::m_txTrace))
     ;
@@ -86,6 +88,13 @@ CsmacaPhy::SetDevice (Ptr<Object> device)
   m_device = device;
 }
 
+void
+CsmacaPhy::SetChannel (Ptr<CsmacaChannel> channel)
+{
+  m_channel = channel;
+  m_channel->Add (this);
+}
+
 Ptr<Object>
 CsmacaPhy::GetMobility ()
 {
@@ -113,7 +122,7 @@ CsmacaPhy::GetDevice (void) const
 int64_t
 CsmacaPhy::AssignStreams (int64_t stream)
 {
-  NS_LOG_FUNCTION (this << stream);
+  CSMACA_LOG_FUNCTION (this << stream);
   m_random->SetStream (stream);
   return 1;
 }
@@ -121,7 +130,7 @@ CsmacaPhy::AssignStreams (int64_t stream)
 void
 CsmacaPhy::StartSend (Ptr<Packet> packet, CsmacaPreamble preamble)
 {
-  NS_LOG_FUNCTION (this);
+  CSMACA_LOG_FUNCTION (this);
   if (m_state->IsStateRx ())
     {
       m_endRxEvent.Cancel ();
@@ -130,13 +139,16 @@ CsmacaPhy::StartSend (Ptr<Packet> packet, CsmacaPreamble preamble)
   m_txTrace (packet);
   Time txDuration = Seconds((double)packet->GetSize () / preamble.GetRate ()) + preamble.GetDuration ();
   m_state->SwitchToTx (txDuration);
-  m_channel->Send (packet, preamble, m_txPowerDbm + m_txGainDb, this);
+  if (m_channel != 0)
+    {
+      m_channel->Send (packet, preamble, m_txPowerDbm + m_txGainDb, this);
+    }
 }
 
 void
 CsmacaPhy::StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxPowerDbm)
 {
-  NS_LOG_FUNCTION (this << rxPowerDbm + m_rxGainDb);
+  CSMACA_LOG_FUNCTION (this << rxPowerDbm + m_rxGainDb);
   double rxPowerW = DbmToW (rxPowerDbm + m_rxGainDb);
   Time rxDuration = Seconds((double)packet->GetSize () / preamble.GetRate ()) + preamble.GetDuration ();
   Ptr<CsmacaInterferenceHelper::Event> event;
@@ -144,11 +156,11 @@ CsmacaPhy::StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxP
   switch (m_state->GetState ())
     {
     case CsmacaPhyState::RX:
-      NS_LOG_DEBUG ("Can not receive because state is RX");
+      CSMACA_LOG_DEBUG ("Can not receive because state is RX");
       goto maybeCcaBusy;
       break;
     case CsmacaPhyState::TX:
-      NS_LOG_DEBUG ("Can not receive because state is TX");
+      CSMACA_LOG_DEBUG ("Can not receive because state is TX");
       goto maybeCcaBusy;
     break;
     case CsmacaPhyState::CCA_BUSY:
@@ -157,6 +169,8 @@ CsmacaPhy::StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxP
 	{
 	  m_interference.NotifyRxStart ();
 	  m_state->SwitchToRx (rxDuration);
+	  CSMACA_COUNT (PHY_RECEPTIONS_STARTED);
+	  CSMACA_COUNT (PHY_EVENTS_SCHEDULED);
 	  m_endRxEvent = Simulator::Schedule (rxDuration,
 					      &CsmacaPhy::EndReceive,
 					      this,
@@ -165,7 +179,7 @@ CsmacaPhy::StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxP
 	}
       else
 	{
-	  NS_LOG_DEBUG ("Can not receive because rxPower is small: " << rxPowerDbm + m_rxGainDb);
+	  CSMACA_LOG_DEBUG ("Can not receive because rxPower is small: " << rxPowerDbm + m_rxGainDb);
 	  goto maybeCcaBusy;
 	}
       break;
@@ -173,6 +187,7 @@ CsmacaPhy::StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxP
   return;
 
 maybeCcaBusy:
+  CSMACA_COUNT (PHY_RECEPTIONS_CULLED);
   Time delayUntilCcaEnd = m_interference.GetEnergyDuration (m_ccaMode1ThresholdW);
   if (!delayUntilCcaEnd.IsZero ())
     {
@@ -183,14 +198,20 @@ maybeCcaBusy:
 void
 CsmacaPhy::EndReceive (Ptr<Packet> packet,  Ptr<CsmacaInterferenceHelper::Event> event)
 {
-  NS_LOG_FUNCTION (this << packet);
+  CSMACA_LOG_FUNCTION (this << packet);
   NS_ASSERT (event->GetEndTime () == Simulator::Now ());
 
+  if (event->GetPreamble ().IsAggregation ())
+    {
+      EndReceiveAmpdu (packet, event);
+      return;
+    }
+
   struct CsmacaInterferenceHelper::SnrPer snrPer;
   snrPer = m_interference.CalculateSnrPer (event);
   m_interference.NotifyRxEnd ();
 
-  NS_LOG_DEBUG ("rate=" << (event->GetPreamble ().GetRate ()) <<
+  CSMACA_LOG_DEBUG ("rate=" << (event->GetPreamble ().GetRate ()) <<
                 ", snr=" << snrPer.snr << ", per=" << snrPer.per << ", size=" << packet->GetSize ());
 
   if (m_random->GetValue () > snrPer.per)
@@ -203,6 +224,45 @@ CsmacaPhy::EndReceive (Ptr<Packet> packet,  Ptr<CsmacaInterferenceHelper::Event>
     }
 }
 
+void
+CsmacaPhy::EndReceiveAmpdu (Ptr<Packet> packet,  Ptr<CsmacaInterferenceHelper::Event> event)
+{
+  CSMACA_LOG_FUNCTION (this << packet);
+  CsmacaPreamble preamble = event->GetPreamble ();
+  CsmacaMpduAggregator::DeaggregatedMpdus mpdus = CsmacaMpduAggregator::Deaggregate (packet);
+
+  // Every subframe is decoded on its own: only the interference
+  // which overlaps its delimiter and MPDU counts against it.
+  std::vector<bool> statusPerMpdu;
+  bool anyOk = false;
+  Time payloadStart = event->GetStartTime () + preamble.GetDuration ();
+  uint32_t offset = 0;
+  for (CsmacaMpduAggregator::DeaggregatedMpdusCI i = mpdus.begin (); i != mpdus.end (); i++)
+    {
+      uint32_t subframeSize = CSMACA_AMPDU_DELIMITER_LENGTH + i->second.GetLength ();
+      Time windowStart = payloadStart + Seconds ((double)offset / preamble.GetRate ());
+      Time windowEnd = payloadStart + Seconds ((double)(offset + subframeSize) / preamble.GetRate ());
+      struct CsmacaInterferenceHelper::SnrPer snrPer;
+      snrPer = m_interference.CalculateSnrPer (event, windowStart, windowEnd);
+      bool ok = m_random->GetValue () > snrPer.per;
+      CSMACA_LOG_DEBUG ("subframe offset=" << offset << ", size=" << subframeSize <<
+                    ", snr=" << snrPer.snr << ", per=" << snrPer.per);
+      statusPerMpdu.push_back (ok);
+      anyOk = anyOk || ok;
+      offset += subframeSize + (4 - subframeSize % 4) % 4;
+    }
+  m_interference.NotifyRxEnd ();
+
+  if (anyOk)
+    {
+      m_state->EndReceiveAmpdu (mpdus, statusPerMpdu);
+    }
+  else
+    {
+      m_state->EndReceiveError (packet);
+    }
+}
+
 double
 CsmacaPhy::DbToRatio (double dB) const
 {
@@ -39,6 +39,7 @@
 #include "csmaca-phy-state-helper.h"
 #include "csmaca-preamble.h"
 #include "csmaca-interference-helper.h"
+#include "csmaca-mpdu-aggregator.h"
 
 namespace ns3 {
 
@@ -64,6 +65,10 @@ public:
 
   void SetMobility (Ptr<Object> mobility);
   void SetDevice (Ptr<Object> device);
+  /**
+   * Attach the PHY to the given channel instead of its own one.
+   */
+  void SetChannel (Ptr<CsmacaChannel> channel);
   Ptr<Object> GetMobility ();
   Ptr<CsmacaPhyStateHelper> GetPhyStateHelper () const;
   Ptr<CsmacaChannel> GetChannel () const;
@@ -73,6 +78,7 @@ public:
   void StartSend (Ptr<Packet> pacekt, CsmacaPreamble preamble);
   void StartReceive (Ptr<Packet> packet, CsmacaPreamble preamble, double rxPowerDbm);
   void EndReceive (Ptr<Packet> packet, Ptr<CsmacaInterferenceHelper::Event> event);
+  void EndReceiveAmpdu (Ptr<Packet> packet, Ptr<CsmacaInterferenceHelper::Event> event);
   double DbToRatio (double dB) const;
   double DbmToW (double dBm) const;
   double RatioToDb (double ratio) const;
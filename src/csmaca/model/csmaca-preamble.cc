@@ -28,7 +28,8 @@ namespace ns3 {
 CsmacaPreamble::CsmacaPreamble ()
   : m_rate (6000000 / 8),
     m_bandwidth (20000000),
-    m_duration (MicroSeconds (20))
+    m_duration (MicroSeconds (20)),
+    m_aggregation (false)
 {
 }
 
@@ -51,6 +52,11 @@ CsmacaPreamble::SetDuration (Time duration){
   m_duration = duration;
 }
 
+void
+CsmacaPreamble::SetAggregation (bool aggregation){
+  m_aggregation = aggregation;
+}
+
 uint32_t
 CsmacaPreamble::GetRate (){
   return m_rate;
@@ -65,4 +71,9 @@ Time
 CsmacaPreamble::GetDuration (){
   return m_duration;
 }
+
+bool
+CsmacaPreamble::IsAggregation (){
+  return m_aggregation;
+}
 }
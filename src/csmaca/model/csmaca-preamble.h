@@ -35,9 +35,11 @@ public:
   void SetRate (uint32_t rate);
   void SetBandwidth (uint32_t bandwidth);
   void SetDuration (Time duration);
+  void SetAggregation (bool aggregation);
   uint32_t GetRate ();
   uint32_t GetBandwidth ();
   Time GetDuration ();
+  bool IsAggregation ();
 private:
   uint32_t m_rate;
   uint32_t m_bandwidth;
@@ -53,6 +55,7 @@ private:
       Total:   24 [bits]
    */
   Time m_duration;
+  bool m_aggregation; // the payload is an aggregated frame
 };
 }
 
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "ns3/socket.h"
+#include "csmaca-qos-utils.h"
+
+namespace ns3 {
+
+enum CsmacaAcIndex
+CsmacaQosUtilsMapTidToAc (uint8_t tid)
+{
+  switch (tid)
+    {
+    case 1:
+    case 2:
+      return CSMACA_AC_BK;
+    case 4:
+    case 5:
+      return CSMACA_AC_VI;
+    case 6:
+    case 7:
+      return CSMACA_AC_VO;
+    default:
+      return CSMACA_AC_BE;
+    }
+}
+
+uint8_t
+CsmacaQosUtilsGetTidForPacket (Ptr<const Packet> packet, uint16_t protocolNumber)
+{
+  SocketIpTosTag tosTag;
+  if (packet->PeekPacketTag (tosTag))
+    {
+      return tosTag.GetTos () >> 5;
+    }
+  // Version/IHL and TOS are the first two bytes of an IPv4 header
+  if (protocolNumber == 0x0800 && packet->GetSize () >= 2)
+    {
+      uint8_t buffer[2];
+      packet->CopyData (buffer, 2);
+      if ((buffer[0] >> 4) == 4)
+        {
+          return buffer[1] >> 5;
+        }
+    }
+  return 0;
+}
+
+} // namespace ns3
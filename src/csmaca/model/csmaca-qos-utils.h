@@ -0,0 +1,72 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_QOS_UTILS_H
+#define CSMACA_QOS_UTILS_H
+
+#include <stdint.h>
+#include "ns3/packet.h"
+
+namespace ns3 {
+
+/**
+ * The access categories, in the numbering of IEEE 802.11e
+ */
+enum CsmacaAcIndex
+{
+  CSMACA_AC_BE = 0,
+  CSMACA_AC_BK = 1,
+  CSMACA_AC_VI = 2,
+  CSMACA_AC_VO = 3,
+  CSMACA_AC_N = 4
+};
+
+/**
+ * The access categories from the highest to the lowest priority.
+ * The first one wins an internal collision.
+ */
+static const enum CsmacaAcIndex CSMACA_ACS_BY_PRIORITY[CSMACA_AC_N] =
+{
+  CSMACA_AC_VO, CSMACA_AC_VI, CSMACA_AC_BE, CSMACA_AC_BK
+};
+
+/**
+ * Maps a user priority (TID) to its access category as in IEEE 802.1D.
+ *
+ * \param tid the user priority, 0 to 7
+ * \return the access category
+ */
+enum CsmacaAcIndex CsmacaQosUtilsMapTidToAc (uint8_t tid);
+
+/**
+ * The user priority is the IP precedence, i.e. the three most
+ * significant bits of the TOS field. It is taken from a SocketIpTosTag
+ * if the packet carries one, otherwise from the IPv4 header at the
+ * front of the packet. Other packets get the best effort priority 0.
+ *
+ * \param packet the packet, without the LLC header
+ * \param protocolNumber the protocol number given to NetDevice::Send
+ * \return the user priority of the packet
+ */
+uint8_t CsmacaQosUtilsGetTidForPacket (Ptr<const Packet> packet, uint16_t protocolNumber);
+
+} // namespace ns3
+
+#endif /* CSMACA_QOS_UTILS_H */
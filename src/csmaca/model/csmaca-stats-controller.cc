@@ -0,0 +1,363 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <cmath>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-stats-controller.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaStatsController");
+
+namespace ns3 {
+
+/**
+ * The number of samples per batch of MSER-5
+ */
+static const uint32_t CSMACA_MSER_BATCH = 5;
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaStatsController);
+
+TypeId
+CsmacaStatsController::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaStatsController")
+    .SetParent<Object> ()
+    .AddConstructor<CsmacaStatsController> ()
+    .AddAttribute ("SampleInterval", "Time over which each throughput sample is averaged.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&CsmacaStatsController::m_sampleInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Window", "Length of the measurement after the warm-up. "
+                   "0 measures until the confidence interval is narrow enough.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&CsmacaStatsController::m_window),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxTime", "Time after Start at which the measurement ends in any case.",
+                   TimeValue (Seconds (20)),
+                   MakeTimeAccessor (&CsmacaStatsController::m_maxTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("RelativePrecision", "Target half width of the confidence interval, relative to the mean.",
+                   DoubleValue (0.05),
+                   MakeDoubleAccessor (&CsmacaStatsController::m_relativePrecision),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ConfidenceLevel", "Confidence level of the interval.",
+                   DoubleValue (0.95),
+                   MakeDoubleAccessor (&CsmacaStatsController::m_confidenceLevel),
+                   MakeDoubleChecker<double> (0.5, 0.999))
+    .AddAttribute ("MinBatches", "Number of batches of five samples needed before the warm-up "
+                   "is detected, and after it before the interval is trusted.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&CsmacaStatsController::m_minBatches),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("StopSimulation", "Stop the simulator when the measurement ends.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&CsmacaStatsController::m_stopSimulation),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Done", "The measurement has ended with the given mean and half width in bit/s",
+                     MakeTraceSourceAccessor (&CsmacaStatsController::m_doneTrace))
+  ;
+  return tid;
+}
+
+CsmacaStatsController::CsmacaStatsController ()
+  : m_bytes (0),
+    m_warmupBatches (-1),
+    m_mean (0),
+    m_halfWidth (0),
+    m_done (false)
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+CsmacaStatsController::~CsmacaStatsController ()
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+void
+CsmacaStatsController::DoDispose (void)
+{
+  m_sampleEvent.Cancel ();
+  Object::DoDispose ();
+}
+
+double
+CsmacaStatsController::GetStudentProbability (double t, uint32_t df)
+{
+  // Closed forms for an integer number of degrees of freedom
+  // (Abramowitz and Stegun 26.7.3 and 26.7.4)
+  double theta = std::atan (t / std::sqrt (double (df)));
+  double c2 = std::cos (theta) * std::cos (theta);
+  double term = 1;
+  double sum = 1;
+  if (df % 2 == 1)
+    {
+      for (uint32_t j = 1; 2 * j + 3 <= df; j++)
+        {
+          term *= c2 * (2 * j) / (2 * j + 1);
+          sum += term;
+        }
+      double series = df == 1 ? 0 : std::sin (theta) * std::cos (theta) * sum;
+      return 2 / M_PI * (theta + series);
+    }
+  for (uint32_t j = 1; 2 * j + 2 <= df; j++)
+    {
+      term *= c2 * (2 * j - 1) / (2 * j);
+      sum += term;
+    }
+  return std::sin (theta) * sum;
+}
+
+double
+CsmacaStatsController::GetStudentQuantile (double level, uint32_t df)
+{
+  NS_ASSERT (df > 0);
+  if (df <= 30)
+    {
+      // The expansion below is too low for few degrees of freedom:
+      // invert the exact distribution by bisection
+      double low = 0;
+      double high = 1;
+      while (GetStudentProbability (high, df) < level)
+        {
+          low = high;
+          high *= 2;
+        }
+      for (uint32_t i = 0; i < 60; i++)
+        {
+          double middle = (low + high) / 2;
+          if (GetStudentProbability (middle, df) < level)
+            {
+              low = middle;
+            }
+          else
+            {
+              high = middle;
+            }
+        }
+      return (low + high) / 2;
+    }
+  // Rational approximation of the normal quantile (Abramowitz and
+  // Stegun 26.2.23), then its Cornish-Fisher expansion
+  double p = (1 - level) / 2;
+  double t = std::sqrt (-2 * std::log (p));
+  double z = t - (2.515517 + 0.802853 * t + 0.010328 * t * t)
+    / (1 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+  double v = df;
+  double z3 = z * z * z;
+  double z5 = z3 * z * z;
+  double z7 = z5 * z * z;
+  return z + (z3 + z) / (4 * v)
+    + (5 * z5 + 16 * z3 + 3 * z) / (96 * v * v)
+    + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * v * v * v);
+}
+
+void
+CsmacaStatsController::Start (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  m_start = Simulator::Now ();
+  m_bytes = 0;
+  m_samples.clear ();
+  m_batches.clear ();
+  m_warmupBatches = -1;
+  m_mean = 0;
+  m_halfWidth = 0;
+  m_done = false;
+  m_sampleEvent.Cancel ();
+  m_sampleEvent = Simulator::Schedule (m_sampleInterval, &CsmacaStatsController::Sample, this);
+}
+
+void
+CsmacaStatsController::NotifyRx (uint32_t bytes)
+{
+  m_bytes += bytes;
+}
+
+bool
+CsmacaStatsController::IsDone (void) const
+{
+  return m_done;
+}
+
+double
+CsmacaStatsController::GetMean (void) const
+{
+  return m_mean;
+}
+
+double
+CsmacaStatsController::GetHalfWidth (void) const
+{
+  return m_halfWidth;
+}
+
+Time
+CsmacaStatsController::GetWarmup (void) const
+{
+  if (m_warmupBatches < 0)
+    {
+      return Seconds (0);
+    }
+  return Seconds (m_sampleInterval.GetSeconds () * m_warmupBatches * CSMACA_MSER_BATCH);
+}
+
+void
+CsmacaStatsController::Sample (void)
+{
+  m_samples.push_back (m_bytes * 8 / m_sampleInterval.GetSeconds ());
+  m_bytes = 0;
+  if (m_samples.size () % CSMACA_MSER_BATCH == 0)
+    {
+      double sum = 0;
+      for (uint32_t i = m_samples.size () - CSMACA_MSER_BATCH; i < m_samples.size (); i++)
+        {
+          sum += m_samples[i];
+        }
+      m_batches.push_back (sum / CSMACA_MSER_BATCH);
+      if (m_warmupBatches < 0)
+        {
+          m_warmupBatches = DetectWarmup ();
+          if (m_warmupBatches >= 0)
+            {
+              CSMACA_LOG_DEBUG ("warm-up " << GetWarmup ());
+            }
+        }
+    }
+
+  if (m_warmupBatches >= 0)
+    {
+      UpdateEstimate ();
+      uint32_t measured = m_batches.size () - m_warmupBatches;
+      if (m_window > Seconds (0))
+        {
+          if (Simulator::Now () - m_start - GetWarmup () >= m_window)
+            {
+              Finish ();
+              return;
+            }
+        }
+      else if (measured >= m_minBatches && m_halfWidth <= m_relativePrecision * std::fabs (m_mean))
+        {
+          Finish ();
+          return;
+        }
+    }
+  if (Simulator::Now () - m_start >= m_maxTime)
+    {
+      if (m_warmupBatches < 0)
+        {
+          // Too short to find the warm-up: keep the second half
+          m_warmupBatches = m_batches.size () / 2;
+          UpdateEstimate ();
+        }
+      Finish ();
+      return;
+    }
+  m_sampleEvent = Simulator::Schedule (m_sampleInterval, &CsmacaStatsController::Sample, this);
+}
+
+int32_t
+CsmacaStatsController::DetectWarmup (void) const
+{
+  uint32_t k = m_batches.size ();
+  if (k < m_minBatches)
+    {
+      return -1;
+    }
+  // MSER (d) = sum over j >= d of (Z_j - mean_d)^2 / (k - d)^2, with
+  // the sums taken from the end
+  double sum = 0;
+  double sumSquares = 0;
+  double best = 0;
+  int32_t bestD = -1;
+  for (int32_t d = k - 1; d >= 0; d--)
+    {
+      sum += m_batches[d];
+      sumSquares += m_batches[d] * m_batches[d];
+      double n = k - d;
+      if (n < 2)
+        {
+          continue;
+        }
+      double mser = (sumSquares - sum * sum / n) / (n * n);
+      if (bestD < 0 || mser <= best)
+        {
+          best = mser;
+          bestD = d;
+        }
+    }
+  if (bestD > static_cast<int32_t> (k / 2))
+    {
+      return -1;
+    }
+  return bestD;
+}
+
+void
+CsmacaStatsController::UpdateEstimate (void)
+{
+  double sum = 0;
+  uint32_t n = 0;
+  for (uint32_t i = m_warmupBatches * CSMACA_MSER_BATCH; i < m_samples.size (); i++)
+    {
+      sum += m_samples[i];
+      n++;
+    }
+  m_mean = n > 0 ? sum / n : 0;
+
+  uint32_t batches = m_batches.size () - m_warmupBatches;
+  if (batches < 2)
+    {
+      m_halfWidth = 0;
+      return;
+    }
+  double batchSum = 0;
+  double batchSumSquares = 0;
+  for (uint32_t i = m_warmupBatches; i < m_batches.size (); i++)
+    {
+      batchSum += m_batches[i];
+      batchSumSquares += m_batches[i] * m_batches[i];
+    }
+  double variance = (batchSumSquares - batchSum * batchSum / batches) / (batches - 1);
+  variance = variance > 0 ? variance : 0;
+  m_halfWidth = GetStudentQuantile (m_confidenceLevel, batches - 1) * std::sqrt (variance / batches);
+}
+
+void
+CsmacaStatsController::Finish (void)
+{
+  CSMACA_LOG_FUNCTION (this << m_mean << m_halfWidth);
+  m_done = true;
+  m_sampleEvent.Cancel ();
+  m_doneTrace (m_mean, m_halfWidth);
+  if (m_stopSimulation)
+    {
+      Simulator::Stop ();
+    }
+}
+
+} // namespace ns3
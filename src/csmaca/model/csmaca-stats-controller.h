@@ -0,0 +1,129 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_STATS_CONTROLLER_H
+#define CSMACA_STATS_CONTROLLER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * Decides when a throughput measurement is good enough and stops the
+ * simulation there.
+ *
+ * The bytes reported through NotifyRx are turned into one throughput
+ * sample per SampleInterval. The samples are grouped into batches of
+ * five, and the warm-up period is the truncation point which minimizes
+ * the MSER-5 statistic of the batch means; it is only accepted once it
+ * lies in the first half of the run.
+ *
+ * After the warm-up, the controller either measures for a fixed Window,
+ * or, if Window is 0, until the confidence interval of the mean of the
+ * batch means is narrower than RelativePrecision times the mean. In any
+ * case it stops at MaxTime.
+ */
+class CsmacaStatsController : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaStatsController ();
+  virtual ~CsmacaStatsController ();
+
+  /**
+   * Start sampling now.
+   */
+  void Start (void);
+  void NotifyRx (uint32_t bytes);
+
+  /**
+   * \return true once the measurement is over
+   */
+  bool IsDone (void) const;
+  /**
+   * \return the mean throughput in bit/s after the warm-up
+   */
+  double GetMean (void) const;
+  /**
+   * \return the half width in bit/s of the confidence interval of the mean
+   */
+  double GetHalfWidth (void) const;
+  /**
+   * \return the length of the warm-up period, or 0 if not yet detected
+   */
+  Time GetWarmup (void) const;
+
+  /**
+   * \return the quantile of the Student t distribution with df degrees
+   *         of freedom for a two-sided confidence interval of the given level
+   */
+  static double GetStudentQuantile (double level, uint32_t df);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \return the probability that |T| <= t for the Student t distribution
+   *         with df degrees of freedom
+   */
+  static double GetStudentProbability (double t, uint32_t df);
+  void Sample (void);
+  /**
+   * \return the number of batches to truncate as warm-up, or -1 if the
+   *         run is still too short to tell
+   */
+  int32_t DetectWarmup (void) const;
+  void UpdateEstimate (void);
+  void Finish (void);
+
+  Time m_sampleInterval;
+  Time m_window;
+  Time m_maxTime;
+  double m_relativePrecision;
+  double m_confidenceLevel;
+  uint32_t m_minBatches;
+  bool m_stopSimulation;
+
+  Time m_start;
+  uint64_t m_bytes;
+  std::vector<double> m_samples;
+  /**
+   * Means of the batches of five samples
+   */
+  std::vector<double> m_batches;
+  int32_t m_warmupBatches;
+  double m_mean;
+  double m_halfWidth;
+  bool m_done;
+  EventId m_sampleEvent;
+
+  TracedCallback<double, double> m_doneTrace;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_STATS_CONTROLLER_H */
@@ -0,0 +1,89 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "csmaca-timestamp-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaTimestampTag);
+
+CsmacaTimestampTag::CsmacaTimestampTag ()
+  : m_timestamp (0)
+{
+}
+
+CsmacaTimestampTag::CsmacaTimestampTag (Time timestamp)
+  : m_timestamp (timestamp.GetTimeStep ())
+{
+}
+
+TypeId
+CsmacaTimestampTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaTimestampTag")
+    .SetParent<Tag> ()
+    .AddConstructor<CsmacaTimestampTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+CsmacaTimestampTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+CsmacaTimestampTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+CsmacaTimestampTag::Serialize (TagBuffer i) const
+{
+  i.WriteU64 (static_cast<uint64_t> (m_timestamp));
+}
+
+void
+CsmacaTimestampTag::Deserialize (TagBuffer i)
+{
+  m_timestamp = static_cast<int64_t> (i.ReadU64 ());
+}
+
+void
+CsmacaTimestampTag::Print (std::ostream &os) const
+{
+  os << "Timestamp=" << GetTimestamp ();
+}
+
+void
+CsmacaTimestampTag::SetTimestamp (Time timestamp)
+{
+  m_timestamp = timestamp.GetTimeStep ();
+}
+
+Time
+CsmacaTimestampTag::GetTimestamp (void) const
+{
+  return TimeStep (m_timestamp);
+}
+
+} // namespace ns3
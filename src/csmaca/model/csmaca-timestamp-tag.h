@@ -0,0 +1,59 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_TIMESTAMP_TAG_H
+#define CSMACA_TIMESTAMP_TAG_H
+
+#include <stdint.h>
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * Creation time of a packet, carried as a byte tag so that it survives
+ * the headers added and removed on the way to the receiver.
+ *
+ * |Timestamp|
+ *  Timestamp: 64 [bits] (simulator time steps)
+ */
+class CsmacaTimestampTag : public Tag
+{
+public:
+  CsmacaTimestampTag ();
+  explicit CsmacaTimestampTag (Time timestamp);
+
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  void SetTimestamp (Time timestamp);
+  Time GetTimestamp (void) const;
+
+private:
+  int64_t m_timestamp;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_TIMESTAMP_TAG_H */
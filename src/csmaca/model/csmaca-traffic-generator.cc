@@ -0,0 +1,254 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include <fstream>
+#include <sstream>
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-timestamp-tag.h"
+#include "csmaca-traffic-generator.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaTrafficGenerator");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaTrafficGenerator);
+
+TypeId
+CsmacaTrafficGenerator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaTrafficGenerator")
+    .SetParent<Application> ()
+    .AddConstructor<CsmacaTrafficGenerator> ()
+    .AddAttribute ("Destination", "Receiver of the frames.",
+                   Mac48AddressValue (Mac48Address::GetBroadcast ()),
+                   MakeMac48AddressAccessor (&CsmacaTrafficGenerator::m_destination),
+                   MakeMac48AddressChecker ())
+    .AddAttribute ("Protocol", "Protocol number the frames are sent with.",
+                   UintegerValue (0x88b5),
+                   MakeUintegerAccessor (&CsmacaTrafficGenerator::m_protocol),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("PacketSize", "Size of the frames, unless given by the trace file.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&CsmacaTrafficGenerator::m_packetSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxPackets", "Number of frames after which the generator stops. 0 means no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CsmacaTrafficGenerator::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ArrivalProcess", "The arrival process of the frames.",
+                   EnumValue (CsmacaTrafficGenerator::CONSTANT),
+                   MakeEnumAccessor (&CsmacaTrafficGenerator::m_process),
+                   MakeEnumChecker (CsmacaTrafficGenerator::CONSTANT, "Constant",
+                                    CsmacaTrafficGenerator::POISSON, "Poisson",
+                                    CsmacaTrafficGenerator::ON_OFF, "OnOff",
+                                    CsmacaTrafficGenerator::TRACE, "Trace"))
+    .AddAttribute ("Interval", "Time between frames, or its mean for Poisson arrivals.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&CsmacaTrafficGenerator::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("OnTime", "Duration in seconds of the on periods.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                   MakePointerAccessor (&CsmacaTrafficGenerator::m_onTime),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("OffTime", "Duration in seconds of the off periods.",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                   MakePointerAccessor (&CsmacaTrafficGenerator::m_offTime),
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("TraceFile", "File of \"<seconds> [<bytes>]\" lines giving the frames to send.",
+                   StringValue (""),
+                   MakeStringAccessor (&CsmacaTrafficGenerator::m_traceFile),
+                   MakeStringChecker ())
+    .AddTraceSource ("Tx", "A frame has been accepted by the device",
+                     MakeTraceSourceAccessor (&CsmacaTrafficGenerator::m_txTrace))
+    .AddTraceSource ("TxDrop", "A frame has been refused by the device",
+                     MakeTraceSourceAccessor (&CsmacaTrafficGenerator::m_txDropTrace))
+  ;
+  return tid;
+}
+
+CsmacaTrafficGenerator::CsmacaTrafficGenerator ()
+  : m_traceIndex (0),
+    m_sent (0)
+{
+  CSMACA_LOG_FUNCTION (this);
+  m_exponential = CreateObject<ExponentialRandomVariable> ();
+}
+
+CsmacaTrafficGenerator::~CsmacaTrafficGenerator ()
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+void
+CsmacaTrafficGenerator::SetDevice (Ptr<NetDevice> device)
+{
+  m_device = device;
+}
+
+int64_t
+CsmacaTrafficGenerator::AssignStreams (int64_t stream)
+{
+  CSMACA_LOG_FUNCTION (this << stream);
+  m_exponential->SetStream (stream);
+  m_onTime->SetStream (stream + 1);
+  m_offTime->SetStream (stream + 2);
+  return 3;
+}
+
+void
+CsmacaTrafficGenerator::DoDispose (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  m_device = 0;
+  m_exponential = 0;
+  m_onTime = 0;
+  m_offTime = 0;
+  Application::DoDispose ();
+}
+
+void
+CsmacaTrafficGenerator::StartApplication (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (m_device == 0)
+    {
+      NS_ABORT_MSG_IF (GetNode ()->GetNDevices () == 0, "CsmacaTrafficGenerator: the node has no device");
+      m_device = GetNode ()->GetDevice (0);
+    }
+  m_sent = 0;
+  m_traceStart = Simulator::Now ();
+  if (m_process == TRACE)
+    {
+      LoadTrace ();
+      m_traceIndex = 0;
+      ScheduleNext ();
+      return;
+    }
+  if (m_process == ON_OFF)
+    {
+      m_onEnd = Simulator::Now () + Seconds (m_onTime->GetValue ());
+    }
+  m_sendEvent = Simulator::ScheduleNow (&CsmacaTrafficGenerator::SendPacket, this, m_packetSize);
+}
+
+void
+CsmacaTrafficGenerator::StopApplication (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+}
+
+void
+CsmacaTrafficGenerator::LoadTrace (void)
+{
+  m_trace.clear ();
+  std::ifstream file (m_traceFile.c_str ());
+  NS_ABORT_MSG_UNLESS (file.is_open (), "CsmacaTrafficGenerator: cannot open " << m_traceFile);
+  std::string line;
+  while (std::getline (file, line))
+    {
+      std::istringstream iss (line);
+      double seconds;
+      if (!(iss >> seconds))
+        {
+          // Blank or comment line
+          continue;
+        }
+      uint32_t size;
+      if (!(iss >> size) || size == 0)
+        {
+          size = m_packetSize;
+        }
+      m_trace.push_back (std::make_pair (Seconds (seconds), size));
+    }
+}
+
+void
+CsmacaTrafficGenerator::ScheduleNext (void)
+{
+  if (m_maxPackets > 0 && m_sent >= m_maxPackets)
+    {
+      return;
+    }
+  switch (m_process)
+    {
+    case CONSTANT:
+      m_sendEvent = Simulator::Schedule (m_interval, &CsmacaTrafficGenerator::SendPacket, this, m_packetSize);
+      break;
+    case POISSON:
+      {
+        Time gap = Seconds (m_exponential->GetValue (m_interval.GetSeconds (), 0));
+        m_sendEvent = Simulator::Schedule (gap, &CsmacaTrafficGenerator::SendPacket, this, m_packetSize);
+      }
+      break;
+    case ON_OFF:
+      {
+        Time next = Simulator::Now () + m_interval;
+        if (next >= m_onEnd)
+          {
+            // Skip the off period which follows the current on period
+            next = m_onEnd + Seconds (m_offTime->GetValue ());
+            m_onEnd = next + Seconds (m_onTime->GetValue ());
+          }
+        m_sendEvent = Simulator::Schedule (next - Simulator::Now (), &CsmacaTrafficGenerator::SendPacket, this, m_packetSize);
+      }
+      break;
+    case TRACE:
+      if (m_traceIndex < m_trace.size ())
+        {
+          Time at = m_traceStart + m_trace[m_traceIndex].first;
+          uint32_t size = m_trace[m_traceIndex].second;
+          m_traceIndex++;
+          Time delay = at > Simulator::Now () ? at - Simulator::Now () : Seconds (0);
+          m_sendEvent = Simulator::Schedule (delay, &CsmacaTrafficGenerator::SendPacket, this, size);
+        }
+      break;
+    }
+}
+
+void
+CsmacaTrafficGenerator::SendPacket (uint32_t size)
+{
+  CSMACA_LOG_FUNCTION (this << size);
+  Ptr<Packet> packet = Create<Packet> (size);
+  packet->AddByteTag (CsmacaTimestampTag (Simulator::Now ()));
+  if (m_device->Send (packet, m_destination, m_protocol))
+    {
+      m_txTrace (packet);
+    }
+  else
+    {
+      m_txDropTrace (packet);
+    }
+  m_sent++;
+  ScheduleNext ();
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_TRAFFIC_GENERATOR_H
+#define CSMACA_TRAFFIC_GENERATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+#include "ns3/application.h"
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * Sends frames straight through a NetDevice, without sockets, IP or
+ * ARP, for studies of the MAC alone.
+ *
+ * Frames are handed to NetDevice::Send with the configured protocol
+ * number, which a CsmacaTrafficSink on the receiver listens to. Every
+ * frame carries a CsmacaTimestampTag of its creation time. The arrival
+ * process is one of
+ *  - CONSTANT: one frame every Interval;
+ *  - POISSON: exponential inter-arrival times of mean Interval;
+ *  - ON_OFF: one frame every Interval during the on periods, whose
+ *    durations are drawn from OnTime and OffTime;
+ *  - TRACE: the frames of TraceFile, one "<seconds> [<bytes>]" line
+ *    per frame, times being relative to the start of the application.
+ */
+class CsmacaTrafficGenerator : public Application
+{
+public:
+  enum ArrivalProcess
+  {
+    CONSTANT,
+    POISSON,
+    ON_OFF,
+    TRACE
+  };
+
+  static TypeId GetTypeId (void);
+
+  CsmacaTrafficGenerator ();
+  virtual ~CsmacaTrafficGenerator ();
+
+  /**
+   * \param device the device to send through; by default the first
+   *        device of the node
+   */
+  void SetDevice (Ptr<NetDevice> device);
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void LoadTrace (void);
+  void ScheduleNext (void);
+  void SendPacket (uint32_t size);
+
+  Ptr<NetDevice> m_device;
+  Mac48Address m_destination;
+  uint16_t m_protocol;
+  uint32_t m_packetSize;
+  uint32_t m_maxPackets;
+  enum ArrivalProcess m_process;
+  Time m_interval;
+  Ptr<ExponentialRandomVariable> m_exponential;
+  Ptr<RandomVariableStream> m_onTime;
+  Ptr<RandomVariableStream> m_offTime;
+  Time m_onEnd;
+  std::string m_traceFile;
+  /**
+   * Arrival time relative to the start and size of the trace frames
+   */
+  std::vector<std::pair<Time, uint32_t> > m_trace;
+  uint32_t m_traceIndex;
+  Time m_traceStart;
+
+  uint32_t m_sent;
+  EventId m_sendEvent;
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  TracedCallback<Ptr<const Packet> > m_txDropTrace;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_TRAFFIC_GENERATOR_H */
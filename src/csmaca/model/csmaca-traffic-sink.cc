@@ -0,0 +1,166 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "csmaca-timestamp-tag.h"
+#include "csmaca-traffic-sink.h"
+#include "csmaca-log.h"
+
+NS_LOG_COMPONENT_DEFINE ("CsmacaTrafficSink");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CsmacaTrafficSink);
+
+TypeId
+CsmacaTrafficSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmacaTrafficSink")
+    .SetParent<Application> ()
+    .AddConstructor<CsmacaTrafficSink> ()
+    .AddAttribute ("Protocol", "Protocol number to receive the frames of.",
+                   UintegerValue (0x88b5),
+                   MakeUintegerAccessor (&CsmacaTrafficSink::m_protocol),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddTraceSource ("Rx", "A frame has been received",
+                     MakeTraceSourceAccessor (&CsmacaTrafficSink::m_rxTrace))
+    .AddTraceSource ("Delay", "A timestamped frame has been received after the given one-way delay",
+                     MakeTraceSourceAccessor (&CsmacaTrafficSink::m_delayTrace))
+  ;
+  return tid;
+}
+
+CsmacaTrafficSink::CsmacaTrafficSink ()
+  : m_listening (false),
+    m_totalRx (0),
+    m_totalPackets (0)
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+CsmacaTrafficSink::~CsmacaTrafficSink ()
+{
+  CSMACA_LOG_FUNCTION (this);
+}
+
+uint64_t
+CsmacaTrafficSink::GetTotalRx (void) const
+{
+  return m_totalRx;
+}
+
+uint32_t
+CsmacaTrafficSink::GetTotalPackets (void) const
+{
+  return m_totalPackets;
+}
+
+std::vector<Mac48Address>
+CsmacaTrafficSink::GetFlows (void) const
+{
+  std::vector<Mac48Address> flows;
+  for (std::map<Mac48Address, Flow>::const_iterator i = m_flows.begin (); i != m_flows.end (); i++)
+    {
+      flows.push_back (i->first);
+    }
+  return flows;
+}
+
+CsmacaLatencyHistogram
+CsmacaTrafficSink::GetDelayHistogram (Mac48Address source) const
+{
+  std::map<Mac48Address, Flow>::const_iterator i = m_flows.find (source);
+  return i == m_flows.end () ? CsmacaLatencyHistogram () : i->second.delay;
+}
+
+CsmacaLatencyHistogram
+CsmacaTrafficSink::GetJitterHistogram (Mac48Address source) const
+{
+  std::map<Mac48Address, Flow>::const_iterator i = m_flows.find (source);
+  return i == m_flows.end () ? CsmacaLatencyHistogram () : i->second.jitter;
+}
+
+CsmacaLatencyHistogram
+CsmacaTrafficSink::GetDelayHistogram (void) const
+{
+  CsmacaLatencyHistogram all;
+  for (std::map<Mac48Address, Flow>::const_iterator i = m_flows.begin (); i != m_flows.end (); i++)
+    {
+      all.Merge (i->second.delay);
+    }
+  return all;
+}
+
+void
+CsmacaTrafficSink::StartApplication (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (!m_listening)
+    {
+      // A null device listens on all the devices of the node
+      GetNode ()->RegisterProtocolHandler (MakeCallback (&CsmacaTrafficSink::Receive, this),
+                                           m_protocol, 0);
+      m_listening = true;
+    }
+}
+
+void
+CsmacaTrafficSink::StopApplication (void)
+{
+  CSMACA_LOG_FUNCTION (this);
+  if (m_listening)
+    {
+      GetNode ()->UnregisterProtocolHandler (MakeCallback (&CsmacaTrafficSink::Receive, this));
+      m_listening = false;
+    }
+}
+
+void
+CsmacaTrafficSink::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                            const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  CSMACA_LOG_FUNCTION (this << packet << from);
+  m_totalRx += packet->GetSize ();
+  m_totalPackets++;
+  m_rxTrace (packet, from);
+
+  CsmacaTimestampTag timestamp;
+  if (!packet->FindFirstMatchingByteTag (timestamp) || !Mac48Address::IsMatchingType (from))
+    {
+      return;
+    }
+  Time delay = Simulator::Now () - timestamp.GetTimestamp ();
+  Flow &flow = m_flows[Mac48Address::ConvertFrom (from)];
+  if (flow.delay.GetCount () > 0)
+    {
+      Time difference = delay - flow.lastDelay;
+      flow.jitter.Add (Abs (difference));
+    }
+  flow.delay.Add (delay);
+  flow.lastDelay = delay;
+  m_delayTrace (packet, from, delay);
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; -*- */
+/*
+ * Copyright (c) 2014 Yusuke Sugiyama
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., Saruwatari Lab, Shizuoka University, Japan
+ *
+ * Author: Yusuke Sugiyama <sugiyama@aurum.cs.inf.shizuoka.ac.jp>
+ */
+
+#ifndef CSMACA_TRAFFIC_SINK_H
+#define CSMACA_TRAFFIC_SINK_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "ns3/application.h"
+#include "ns3/net-device.h"
+#include "ns3/address.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "csmaca-latency-histogram.h"
+
+namespace ns3 {
+
+/**
+ * Receives the frames of CsmacaTrafficGenerator through a protocol
+ * handler of the node, without sockets or IP.
+ *
+ * A flow is the set of frames from one source. For every flow the sink
+ * keeps a histogram of the one-way delay of the frames carrying a
+ * CsmacaTimestampTag, and one of the jitter, the absolute difference
+ * between the delays of consecutive frames.
+ */
+class CsmacaTrafficSink : public Application
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CsmacaTrafficSink ();
+  virtual ~CsmacaTrafficSink ();
+
+  /**
+   * \return the number of bytes received so far
+   */
+  uint64_t GetTotalRx (void) const;
+  /**
+   * \return the number of frames received so far
+   */
+  uint32_t GetTotalPackets (void) const;
+  /**
+   * \return the sources of the flows received so far
+   */
+  std::vector<Mac48Address> GetFlows (void) const;
+  /**
+   * \return the delay histogram of the flow from the given source,
+   *         empty if nothing was received from it
+   */
+  CsmacaLatencyHistogram GetDelayHistogram (Mac48Address source) const;
+  CsmacaLatencyHistogram GetJitterHistogram (Mac48Address source) const;
+  /**
+   * \return the delay histogram of all the flows together
+   */
+  CsmacaLatencyHistogram GetDelayHistogram (void) const;
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  struct Flow
+  {
+    CsmacaLatencyHistogram delay;
+    CsmacaLatencyHistogram jitter;
+    Time lastDelay;
+  };
+  std::map<Mac48Address, Flow> m_flows;
+
+  uint16_t m_protocol;
+  bool m_listening;
+  uint64_t m_totalRx;
+  uint32_t m_totalPackets;
+  TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
+  TracedCallback<Ptr<const Packet>, const Address &, Time> m_delayTrace;
+};
+
+} // namespace ns3
+
+#endif /* CSMACA_TRAFFIC_SINK_H */
@@ -1,7 +1,25 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
+#include <algorithm>
+#include <sstream>
+
 // Include a header file from your module to test.
 #include "ns3/csmaca.h"
+#include "ns3/csmaca-helper.h"
+#include "ns3/csmaca-traffic-helper.h"
+#include "ns3/csmaca-traffic-sink.h"
+#include "ns3/csmaca-bianchi-model.h"
+#include "ns3/csmaca-stats-controller.h"
+#include "ns3/csmaca-airtime-mac-queue.h"
+#include "ns3/csmaca-fq-codel-mac-queue.h"
+#include "ns3/csmaca-block-ack-agreement.h"
+#include "ns3/csmaca-mac-trailer.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/mac48-address.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +64,492 @@ CsmacaTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Compare the saturation throughput of the Bianchi model with a
+// simulation of stations which all send to one receiver, with basic
+// access or with every frame protected by RTS/CTS
+class CsmacaBianchiTestCase : public TestCase
+{
+public:
+  CsmacaBianchiTestCase (uint32_t stations, uint32_t payloadSize, bool rts);
+  virtual ~CsmacaBianchiTestCase ();
+
+private:
+  static std::string GetName (uint32_t stations, uint32_t payloadSize, bool rts);
+  virtual void DoRun (void);
+  uint32_t m_stations;
+  uint32_t m_payloadSize;
+  bool m_rts;
+};
+
+CsmacaBianchiTestCase::CsmacaBianchiTestCase (uint32_t stations, uint32_t payloadSize, bool rts)
+  : TestCase (GetName (stations, payloadSize, rts)),
+    m_stations (stations),
+    m_payloadSize (payloadSize),
+    m_rts (rts)
+{
+}
+
+std::string
+CsmacaBianchiTestCase::GetName (uint32_t stations, uint32_t payloadSize, bool rts)
+{
+  std::ostringstream oss;
+  oss << "Bianchi model matches the simulated saturation throughput, "
+      << stations << " stations, " << payloadSize << " byte payload, "
+      << (rts ? "RTS/CTS" : "basic access");
+  return oss.str ();
+}
+
+CsmacaBianchiTestCase::~CsmacaBianchiTestCase ()
+{
+}
+
+void
+CsmacaBianchiTestCase::DoRun (void)
+{
+  Time duration = Seconds (10);
+  NodeContainer nodes;
+  nodes.Create (m_stations + 1);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (i, 0, 0));
+      nodes.Get (i)->AggregateObject (mobility);
+    }
+  CsmacaHelper csmaca;
+  NetDeviceContainer devices = csmaca.Install (nodes);
+  csmaca.AssignStreams (devices, 0);
+  Mac48Address receiver = Mac48Address::ConvertFrom (devices.Get (0)->GetAddress ());
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<CsmacaMac> mac = DynamicCast<CsmacaNetDevice> (devices.Get (i))->GetMac ();
+      mac->SetAttribute ("RtsThreshold", UintegerValue (m_rts ? 0 : 65535));
+      if (i == 0)
+        {
+          continue;
+        }
+      mac->SetAttribute ("SaturationPacketSize", UintegerValue (m_payloadSize));
+      mac->SetAttribute ("SaturationDestination", Mac48AddressValue (receiver));
+      mac->SetAttribute ("SaturationSource", BooleanValue (true));
+    }
+  CsmacaTrafficHelper traffic;
+  ApplicationContainer sinks = traffic.InstallSink (NodeContainer (nodes.Get (0)));
+  Ptr<CsmacaTrafficSink> sink = DynamicCast<CsmacaTrafficSink> (sinks.Get (0));
+
+  // Read the model parameters before Simulator::Destroy disposes the MAC
+  CsmacaBianchiModel model;
+  model.ReadFrom (DynamicCast<CsmacaNetDevice> (devices.Get (1))->GetMac ());
+
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  double simulated = sink->GetTotalRx () * 8 / duration.GetSeconds ();
+  Simulator::Destroy ();
+
+  double tau = model.GetTransmissionProbability (m_stations);
+  double p = model.GetCollisionProbability (m_stations);
+  NS_TEST_ASSERT_MSG_EQ ((tau > 0 && tau < 2.0 / 17), true, "Transmission probability out of range");
+  NS_TEST_ASSERT_MSG_EQ ((p >= 0 && p < 1), true, "Collision probability out of range");
+  double expected = model.GetThroughput (m_stations, m_payloadSize);
+  NS_TEST_ASSERT_MSG_EQ_TOL (simulated, expected, expected * 0.05,
+                             "Simulated throughput differs from the Bianchi model");
+}
+
+// Check the Student t quantiles used for the confidence intervals
+// against tabulated values
+class CsmacaStudentQuantileTestCase : public TestCase
+{
+public:
+  CsmacaStudentQuantileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaStudentQuantileTestCase::CsmacaStudentQuantileTestCase ()
+  : TestCase ("Student t quantiles match the tables")
+{
+}
+
+void
+CsmacaStudentQuantileTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ_TOL (CsmacaStatsController::GetStudentQuantile (0.95, 1), 12.706, 0.001, "df=1");
+  NS_TEST_ASSERT_MSG_EQ_TOL (CsmacaStatsController::GetStudentQuantile (0.95, 2), 4.303, 0.001, "df=2");
+  NS_TEST_ASSERT_MSG_EQ_TOL (CsmacaStatsController::GetStudentQuantile (0.95, 9), 2.262, 0.001, "df=9");
+  NS_TEST_ASSERT_MSG_EQ_TOL (CsmacaStatsController::GetStudentQuantile (0.99, 30), 2.750, 0.001, "df=30");
+  NS_TEST_ASSERT_MSG_EQ_TOL (CsmacaStatsController::GetStudentQuantile (0.95, 120), 1.980, 0.002, "df=120");
+}
+
+// Deliver MPDUs of one originator to the reordering buffer of a
+// recipient agreement, and return the sequence numbers it releases
+static std::vector<uint16_t>
+ReceiveMpdu (CsmacaRecipientBlockAckAgreement &agreement, uint16_t seq, bool *accepted = 0)
+{
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_DATA);
+  hdr.SetSequenceNumber (seq);
+  CsmacaRecipientBlockAckAgreement::Mpdus released;
+  bool ok = agreement.NotifyReceivedMpdu (Create<Packet> (100), hdr, &released);
+  if (accepted != 0)
+    {
+      *accepted = ok;
+    }
+  std::vector<uint16_t> seqs;
+  for (CsmacaRecipientBlockAckAgreement::Mpdus::const_iterator i = released.begin (); i != released.end (); i++)
+    {
+      seqs.push_back (i->second.GetSequenceNumber ());
+    }
+  return seqs;
+}
+
+// Check that the recipient of a block ack agreement releases MPDUs in
+// sequence order across the wrap of the sequence numbers, and moves
+// its window when the originator has given up older MPDUs
+class CsmacaBlockAckReorderingTestCase : public TestCase
+{
+public:
+  CsmacaBlockAckReorderingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaBlockAckReorderingTestCase::CsmacaBlockAckReorderingTestCase ()
+  : TestCase ("Block ack recipient releases MPDUs in order across the sequence wrap and window jumps")
+{
+}
+
+void
+CsmacaBlockAckReorderingTestCase::DoRun (void)
+{
+  CsmacaRecipientBlockAckAgreement agreement (4094);
+  std::vector<uint16_t> released;
+
+  released = ReceiveMpdu (agreement, 4095);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 0, "4095 waits for 4094");
+  released = ReceiveMpdu (agreement, 4094);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 2, "4094 releases 4094 and 4095");
+  NS_TEST_ASSERT_MSG_EQ (released[0], 4094, "Released out of order");
+  NS_TEST_ASSERT_MSG_EQ (released[1], 4095, "Released out of order");
+  released = ReceiveMpdu (agreement, 1);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 0, "1 waits for 0 after the wrap");
+  released = ReceiveMpdu (agreement, 0);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 2, "0 releases 0 and 1");
+  NS_TEST_ASSERT_MSG_EQ (released[0], 0, "Released out of order");
+  NS_TEST_ASSERT_MSG_EQ (released[1], 1, "Released out of order");
+
+  // The window starts at 2: 3 is buffered, then an MPDU beyond the
+  // window slides it so that the MPDU is its last entry
+  released = ReceiveMpdu (agreement, 3);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 0, "3 waits for 2");
+  uint16_t beyond = 2 + CSMACA_BLOCK_ACK_WINDOW_SIZE + 10;
+  released = ReceiveMpdu (agreement, beyond);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 1, "The jump flushes the buffered MPDU");
+  NS_TEST_ASSERT_MSG_EQ (released[0], 3, "The jump flushes the buffered MPDU");
+  CsmacaBlockAckHeader blockAck;
+  agreement.FillBlockAck (&blockAck);
+  NS_TEST_ASSERT_MSG_EQ (blockAck.GetStartingSequence (), beyond - CSMACA_BLOCK_ACK_WINDOW_SIZE + 1,
+                         "The MPDU beyond the window is not its last entry");
+
+  // A BlockAckReq past the buffered MPDU releases it
+  CsmacaRecipientBlockAckAgreement::Mpdus flushed;
+  agreement.NotifyBlockAckReq (beyond + 1, &flushed);
+  NS_TEST_ASSERT_MSG_EQ (flushed.size (), 1, "The BlockAckReq does not flush the window");
+  NS_TEST_ASSERT_MSG_EQ (flushed.front ().second.GetSequenceNumber (), beyond, "Wrong MPDU flushed");
+}
+
+// Hand frames from a peer directly to the MAC of a single device and
+// record the packets which the device passes up
+class CsmacaMacRxTestCase : public TestCase
+{
+public:
+  CsmacaMacRxTestCase (std::string name);
+
+protected:
+  void Setup (void);
+  /**
+   * \param payload the MSDU or fragment carried by the frame
+   */
+  void Deliver (Ptr<Packet> payload, uint16_t seq, uint8_t fragment, bool moreFragments, bool retry);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  Ptr<CsmacaMac> m_mac;
+  Mac48Address m_peer;
+  std::vector<Ptr<const Packet> > m_received;
+};
+
+CsmacaMacRxTestCase::CsmacaMacRxTestCase (std::string name)
+  : TestCase (name),
+    m_peer (Mac48Address ("00:00:00:00:00:99"))
+{
+}
+
+void
+CsmacaMacRxTestCase::Setup (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  nodes.Get (0)->AggregateObject (CreateObject<ConstantPositionMobilityModel> ());
+  CsmacaHelper csmaca;
+  Ptr<CsmacaNetDevice> device = DynamicCast<CsmacaNetDevice> (csmaca.Install (nodes).Get (0));
+  device->SetReceiveCallback (MakeCallback (&CsmacaMacRxTestCase::Receive, this));
+  m_mac = device->GetMac ();
+  m_received.clear ();
+}
+
+void
+CsmacaMacRxTestCase::Deliver (Ptr<Packet> payload, uint16_t seq, uint8_t fragment, bool moreFragments, bool retry)
+{
+  CsmacaMacHeader hdr;
+  hdr.SetType (CSMACA_MAC_DATA);
+  hdr.SetAddr1 (m_mac->GetAddress ());
+  hdr.SetAddr2 (m_peer);
+  hdr.SetSequenceNumber (seq);
+  hdr.SetFragmentNumber (fragment);
+  if (moreFragments)
+    {
+      hdr.SetMoreFragments ();
+    }
+  if (retry)
+    {
+      hdr.SetRetry ();
+    }
+  Ptr<Packet> frame = payload->Copy ();
+  frame->AddHeader (hdr);
+  frame->AddTrailer (CsmacaMacTrailer ());
+  m_mac->ReceiveOk (frame);
+}
+
+bool
+CsmacaMacRxTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  m_received.push_back (packet);
+  return true;
+}
+
+// Check that duplicates are delivered only once, both in the reordering
+// buffer of a block ack agreement and for frames sent outside of one
+class CsmacaDuplicateTestCase : public CsmacaMacRxTestCase
+{
+public:
+  CsmacaDuplicateTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaDuplicateTestCase::CsmacaDuplicateTestCase ()
+  : CsmacaMacRxTestCase ("Duplicate frames are delivered only once")
+{
+}
+
+void
+CsmacaDuplicateTestCase::DoRun (void)
+{
+  CsmacaRecipientBlockAckAgreement agreement (100);
+  bool accepted;
+  ReceiveMpdu (agreement, 102, &accepted);
+  NS_TEST_ASSERT_MSG_EQ (accepted, true, "An MPDU inside the window is refused");
+  std::vector<uint16_t> released = ReceiveMpdu (agreement, 102, &accepted);
+  NS_TEST_ASSERT_MSG_EQ (accepted, false, "A duplicate inside the window is accepted");
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 0, "A duplicate inside the window is released");
+  ReceiveMpdu (agreement, 100);
+  released = ReceiveMpdu (agreement, 101);
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 2, "101 releases 101 and the buffered 102");
+  released = ReceiveMpdu (agreement, 101, &accepted);
+  NS_TEST_ASSERT_MSG_EQ (accepted, false, "A duplicate older than the window is accepted");
+  NS_TEST_ASSERT_MSG_EQ (released.size (), 0, "A duplicate older than the window is released");
+  ReceiveMpdu (agreement, 100 - CSMACA_BLOCK_ACK_WINDOW_SIZE, &accepted);
+  NS_TEST_ASSERT_MSG_EQ (accepted, false, "An MPDU a window older is accepted");
+
+  // A retransmission whose ACK was lost is acknowledged again but not
+  // delivered; a new frame with the retry bit is delivered
+  Setup ();
+  LlcSnapHeader llc;
+  Ptr<Packet> msdu = Create<Packet> (100);
+  msdu->AddHeader (llc);
+  Deliver (msdu, 5, 0, false, false);
+  Deliver (msdu, 5, 0, false, true);
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 1, "A retransmitted frame is delivered twice");
+  Deliver (msdu, 6, 0, false, true);
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 2, "A new frame with the retry bit is dropped");
+  Simulator::Destroy ();
+}
+
+// Check that fragments are reassembled into the original MSDU when one
+// arrives out of order and another is retransmitted
+class CsmacaReassemblyTestCase : public CsmacaMacRxTestCase
+{
+public:
+  CsmacaReassemblyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaReassemblyTestCase::CsmacaReassemblyTestCase ()
+  : CsmacaMacRxTestCase ("Fragments arriving out of order or twice are reassembled once")
+{
+}
+
+void
+CsmacaReassemblyTestCase::DoRun (void)
+{
+  Setup ();
+  uint8_t data[300];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i & 0xff;
+    }
+  Ptr<Packet> msdu = Create<Packet> (data, sizeof (data));
+  LlcSnapHeader llc;
+  msdu->AddHeader (llc);
+  uint32_t size = msdu->GetSize ();
+  Ptr<Packet> first = msdu->CreateFragment (0, 100);
+  Ptr<Packet> second = msdu->CreateFragment (100, 100);
+  Ptr<Packet> last = msdu->CreateFragment (200, size - 200);
+
+  Deliver (first, 9, 0, true, false);
+  // The last fragment arrives before the second one and is ignored
+  Deliver (last, 9, 2, false, false);
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 0, "An MSDU is delivered with a missing fragment");
+  Deliver (second, 9, 1, true, false);
+  // The ACK of the second fragment was lost
+  Deliver (second, 9, 1, true, true);
+  Deliver (last, 9, 2, false, true);
+  NS_TEST_ASSERT_MSG_EQ (m_received.size (), 1, "The MSDU is not delivered exactly once");
+  NS_TEST_ASSERT_MSG_EQ (m_received[0]->GetSize (), sizeof (data), "The reassembled MSDU has the wrong size");
+  uint8_t reassembled[sizeof (data)];
+  m_received[0]->CopyData (reassembled, sizeof (reassembled));
+  NS_TEST_ASSERT_MSG_EQ (std::equal (data, data + sizeof (data), reassembled), true,
+                         "The reassembled MSDU has the wrong contents");
+  Simulator::Destroy ();
+}
+
+// Check that the FQ-CoDel queue enforces its limits on the sum of its
+// flows, dropping from the longest flow, and that its packet and byte
+// counts follow every enqueue, drop and dequeue
+class CsmacaFqCodelLimitsTestCase : public TestCase
+{
+public:
+  CsmacaFqCodelLimitsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaFqCodelLimitsTestCase::CsmacaFqCodelLimitsTestCase ()
+  : TestCase ("FQ-CoDel queue bounds the sum of its flows")
+{
+}
+
+void
+CsmacaFqCodelLimitsTestCase::DoRun (void)
+{
+  Ptr<CsmacaFqCodelMacQueue> queue = CreateObject<CsmacaFqCodelMacQueue> ();
+  queue->SetMaxSize (4);
+  CsmacaMacHeader longHdr;
+  longHdr.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  CsmacaMacHeader shortHdr;
+  shortHdr.SetAddr1 (Mac48Address ("00:00:00:00:00:02"));
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      queue->Enqueue (Create<Packet> (1000), longHdr);
+    }
+  queue->Enqueue (Create<Packet> (500), shortHdr);
+  NS_TEST_ASSERT_MSG_EQ (queue->GetSize (), 4, "Wrong packet count");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 3500, "Wrong byte count");
+
+  // The longest flow makes room for the newcomer
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (500), shortHdr), true, "The short flow is refused");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetSize (), 4, "The packet limit is exceeded");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 3000, "Wrong byte count after an overflow drop");
+  // A frame of the longest flow itself is refused
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (1000), longHdr), false, "The longest flow grows");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 3000, "Wrong byte count after a refused frame");
+
+  queue->SetMaxSize (10);
+  queue->SetMaxBytes (3500);
+  NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<Packet> (500), shortHdr), true, "A frame within the limits is refused");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 3500, "Wrong byte count");
+
+  CsmacaMacHeader hdr;
+  uint32_t dequeued = 0;
+  while (queue->Dequeue (&hdr) != 0)
+    {
+      dequeued++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (dequeued, 5, "Wrong number of frames dequeued");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetSize (), 0, "Packets left after draining");
+  NS_TEST_ASSERT_MSG_EQ (queue->GetNBytes (), 0, "Bytes left after draining");
+  Simulator::Destroy ();
+}
+
+// Serve a fast destination which is always backlogged and a slow one
+// which only gets its next frame once its queue has emptied, and check
+// that both get about the same medium time
+class CsmacaAirtimeFairnessTestCase : public TestCase
+{
+public:
+  CsmacaAirtimeFairnessTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmacaAirtimeFairnessTestCase::CsmacaAirtimeFairnessTestCase ()
+  : TestCase ("Airtime queue shares the medium time between a slow and a fast destination")
+{
+}
+
+void
+CsmacaAirtimeFairnessTestCase::DoRun (void)
+{
+  Ptr<CsmacaAirtimeMacQueue> queue = CreateObject<CsmacaAirtimeMacQueue> ();
+  Mac48Address slow = Mac48Address ("00:00:00:00:00:01");
+  Mac48Address fast = Mac48Address ("00:00:00:00:00:02");
+  CsmacaMacHeader slowHdr;
+  slowHdr.SetAddr1 (slow);
+  CsmacaMacHeader fastHdr;
+  fastHdr.SetAddr1 (fast);
+  queue->Enqueue (Create<Packet> (1000), slowHdr);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      queue->Enqueue (Create<Packet> (1000), fastHdr);
+    }
+
+  Time slowAirtime = Seconds (0);
+  Time fastAirtime = Seconds (0);
+  bool slowPending = false;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      CsmacaMacHeader hdr;
+      Ptr<const Packet> packet = queue->Dequeue (&hdr);
+      NS_TEST_ASSERT_MSG_NE (packet, 0, "The fast destination is always backlogged");
+      // The next frame of the slow destination arrives after its queue
+      // was seen empty
+      if (slowPending)
+        {
+          queue->Enqueue (Create<Packet> (1000), slowHdr);
+          slowPending = false;
+        }
+      if (hdr.GetAddr1 () == slow)
+        {
+          queue->NotifyAirtime (slow, MicroSeconds (1000));
+          slowAirtime += MicroSeconds (1000);
+          slowPending = true;
+        }
+      else
+        {
+          queue->NotifyAirtime (fast, MicroSeconds (100));
+          fastAirtime += MicroSeconds (100);
+          queue->Enqueue (Create<Packet> (1000), fastHdr);
+        }
+    }
+  double slowShare = slowAirtime.GetSeconds () / (slowAirtime + fastAirtime).GetSeconds ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (slowShare, 0.5, 0.15, "The slow destination does not get its share of the medium time");
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +565,17 @@ CsmacaTestSuite::CsmacaTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new CsmacaTestCase1, TestCase::QUICK);
+  AddTestCase (new CsmacaStudentQuantileTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaFqCodelLimitsTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaAirtimeFairnessTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaBlockAckReorderingTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaDuplicateTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaReassemblyTestCase, TestCase::QUICK);
+  AddTestCase (new CsmacaBianchiTestCase (4, 500, false), TestCase::QUICK);
+  AddTestCase (new CsmacaBianchiTestCase (4, 1500, false), TestCase::QUICK);
+  AddTestCase (new CsmacaBianchiTestCase (4, 1500, true), TestCase::QUICK);
+  AddTestCase (new CsmacaBianchiTestCase (10, 1500, false), TestCase::EXTENSIVE);
+  AddTestCase (new CsmacaBianchiTestCase (10, 1500, true), TestCase::EXTENSIVE);
 }
 
 // Do not forget to allocate an instance of this TestSuite